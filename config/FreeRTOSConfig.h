@@ -46,9 +46,16 @@
 
 /* Scheduler Related */
 #define configUSE_PREEMPTION                    1
-#define configUSE_TICKLESS_IDLE                 0
+/* TICKLESS_IDLE (cmake option) stops the tick while the cores are idle; the
+   releases of PERIODIC_RELEASE_ALARM come from the timer alarms, not the tick,
+   and are the default then (periodicTask.h) */
+#ifndef TICKLESS_IDLE
+#define TICKLESS_IDLE                           0
+#endif
+#define configUSE_TICKLESS_IDLE                 TICKLESS_IDLE
 #define configUSE_IDLE_HOOK                     0
-#define configUSE_TICK_HOOK                     0
+/* the releases of PERIODIC_RELEASE_TICK, see releaseAlarm.h */
+#define configUSE_TICK_HOOK                     1
 #define configTICK_RATE_HZ                      ( ( TickType_t ) 1000 )
 #define configMAX_PRIORITIES                    32
 #define configMINIMAL_STACK_SIZE                ( configSTACK_DEPTH_TYPE ) 256
@@ -72,20 +79,39 @@
 #define configSTACK_DEPTH_TYPE                  uint32_t
 #define configMESSAGE_BUFFER_LENGTH_TYPE        size_t
 
-/* Memory allocation related definitions. */
+/* Memory allocation related definitions. The STATIC_ALLOCATION build (cmake
+option) has no heap, see utils/taskMemory.h */
+#ifndef STATIC_ALLOCATION
+#define STATIC_ALLOCATION                       0
+#endif
+#if STATIC_ALLOCATION
+#define configSUPPORT_STATIC_ALLOCATION         1
+#define configSUPPORT_DYNAMIC_ALLOCATION        0
+#else
 #define configSUPPORT_STATIC_ALLOCATION         0
 #define configSUPPORT_DYNAMIC_ALLOCATION        1
 #define configTOTAL_HEAP_SIZE                   (200*1024)
+#endif
 #define configAPPLICATION_ALLOCATED_HEAP        0
 
 /* Hook function related definitions. */
-#define configCHECK_FOR_STACK_OVERFLOW          0
+#define configCHECK_FOR_STACK_OVERFLOW          1
 #define configUSE_MALLOC_FAILED_HOOK            0
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 
 /* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS           0
-#define configUSE_TRACE_FACILITY                0
+/* the processor time of every task, in microseconds: the counter is the raw low
+   word of the 1 MHz RP2040 timer (TIMERAWL), the budgets of the deadline
+   watchdog (utils/periodicTask.h) are checked against it */
+#ifndef __ASSEMBLER__
+#include "hardware/structs/timer.h"
+#endif
+#define configGENERATE_RUN_TIME_STATS           1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()        ( timer_hw->timerawl )
+/* vTaskGetInfo() reads the run time of a task; the kernel trace also numbers
+   the tasks with the trace facility fields */
+#define configUSE_TRACE_FACILITY                1
 #define configUSE_STATS_FORMATTING_FUNCTIONS    0
 
 /* Co-routine related definitions. */
@@ -109,7 +135,7 @@
 #define configNUM_CORES                         2
 #define configTICK_CORE                         0
 #define configRUN_MULTIPLE_PRIORITIES           1
-#define configUSE_CORE_AFFINITY                 0
+#define configUSE_CORE_AFFINITY                 1
 
 /* RP2040 specific */
 #define configSUPPORT_PICO_SYNC_INTEROP         1
@@ -137,54 +163,17 @@ to exclude the API function. */
 #define INCLUDE_xTaskGetHandle                  1
 #define INCLUDE_xTaskResumeFromISR              1
 #define INCLUDE_xQueueGetMutexHolder            1
+#define INCLUDE_xTimerGetTimerDaemonTaskHandle  1
 
 /* A header file that defines trace macro can be included here. */
 
-// void logTrace(const char *format, ...);
+/* Binary kernel trace: 1 records every context switch, task creation and
+deletion, block and wake-up in the trace rings (utils/traces/kernelTrace.h),
+0 leaves the kernel without any trace hook. */
+#define TRACE_KERNEL_EVENTS                     0
 
-/*
-#define traceTASK_SWITCHED_IN() printf("Task switched in: %s\n", pcTaskGetName(xTaskGetCurrentTaskHandle()))
-
-#define traceTASK_CREATE( pxNewTCB ) printf("Task created: %s\n", pcTaskGetName((TaskHandle_t)pxNewTCB))
-
-#define traceTASK_DELETE( pxTCB ) printf("Task deleted: %s\n", pcTaskGetName((TaskHandle_t)pxTCB))
-
-#define traceTASK_SWITCHED_OUT() printf("Task switched out: %s\n", pcTaskGetName(xTaskGetCurrentTaskHandle()))
-*/
-//#include "utils/traces/traces.h"
-
-void logTrace(uint32_t taskNum, bool isStart, uint32_t timestamp);
-
-// #define traceTASK_SWITCHED_IN() logTrace("{ \"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"%s\",\"pid\": %d, \"tid\": \"%s\", \"ts\": %lu },", \
-//                     pcTaskGetName(pxCurrentTCB), "task", "B", 1, pcTaskGetName(pxCurrentTCB), (unsigned long)(xTaskGetTickCount() * portTICK_PERIOD_MS * 1000))
-
-// #define traceTASK_SWITCHED_OUT() logTrace("{ \"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"%s\",\"pid\": %d, \"tid\": \"%s\", \"ts\": %lu },", \
-//                     pcTaskGetName(pxCurrentTCB), "task", "E", 1, pcTaskGetName(pxCurrentTCB), (unsigned long)(xTaskGetTickCount() * portTICK_PERIOD_MS * 1000))
-
-// #define traceTASK_CREATE( pxNewTCB ) logTrace("{ \"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"%s\",\"pid\": %d, \"tid\": \"%s\", \"ts\": %lu },", \
-//                     pcTaskGetName((TaskHandle_t)pxNewTCB), "task", "M", 1, pcTaskGetName((TaskHandle_t)pxNewTCB), (unsigned long)(xTaskGetTickCount() * portTICK_PERIOD_MS * 1000))
-
-// #define traceTASK_DELETE( pxTCB ) logTrace("{ \"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"%s\",\"pid\": %d, \"tid\": \"%s\", \"ts\": %lu },", \
-//                     pcTaskGetName((TaskHandle_t)pxTCB), "task", "E", 1, pcTaskGetName((TaskHandle_t)pxTCB), (unsigned long)(xTaskGetTickCount() * portTICK_PERIOD_MS * 1000))
-
-// #define traceTASK_SUSPEND( pxTCB ) logTrace("{ \"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"%s\",\"pid\": %d, \"tid\": \"%s\", \"ts\": %lu },", \
-//                     pcTaskGetName((TaskHandle_t)pxTCB), "task", "E", 1, pcTaskGetName((TaskHandle_t)pxTCB), (unsigned long)(xTaskGetTickCount() * portTICK_PERIOD_MS * 1000))
-
-// #define traceTASK_RESUME(xTask) logTrace("{ \"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"%s\",\"pid\": %d, \"tid\": \"%s\", \"ts\": %lu },", \
-//                     pcTaskGetName((TaskHandle_t)xTask), "task", "B", 1, pcTaskGetName((TaskHandle_t)xTask), (unsigned long)(xTaskGetTickCount() * portTICK_PERIOD_MS * 1000))
-
-//#define traceTASK_SWITCHED_IN logTrace((uint32_t)pvTaskGetThreadLocalStoragePointer(NULL, 0), 1, (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS * 1000))
-//#define traceTASK_SWITCHED_OUT logTrace((uint32_t)pvTaskGetThreadLocalStoragePointer(NULL, 0), 0, (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS * 1000))
-
-
-// #define traceTASK_SWITCHED_IN()                                          \
-//     do {                                                                 \
-//         logTrace((uint32_t)atoi(pcTaskGetName(pxCurrentTCB)), true, (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS * 1000)); \
-//     } while (0)
-
-// #define traceTASK_SWITCHED_OUT()                                         \
-//     do {                                                                 \
-//         logTrace((uint32_t)atoi(pcTaskGetName(pxCurrentTCB)), false, (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS * 1000)); \
-//    } while (0)
+#if TRACE_KERNEL_EVENTS
+#include "utils/traces/kernelTrace.h"
+#endif
 
 #endif /* FREERTOS_CONFIG_H */
\ No newline at end of file
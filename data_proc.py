@@ -1,3 +1,7 @@
+# Reference implementation of the trace to Chrome JSON conversion. For large
+# captures and binary traces use trace2json (see host/CMakeLists.txt), a
+# streaming C++ version producing the same output.
+
 import sys
 import csv
 import json
@@ -5,6 +9,9 @@ import json
 # Default input and output file paths
 input_file = 'data.csv'
 output_file = 'output.json'
+# Timestamps in the CSV are in microseconds (timestampNow() on the target).
+# Older captures such as RM.csv used milliseconds: pass --ms to convert those.
+timestamp_scale = 1
 
 # Function to convert CSV data to the required JSON format with preemptions handled
 # The example format that is needed: 
@@ -17,7 +24,7 @@ output_file = 'output.json'
 #     "ts": 0
 # }
 
-def process_data(input_file, output_file):
+def process_data(input_file, output_file, timestamp_scale):
 
     # List to store logging data after adding preemptions
     after_preempt_data = []
@@ -25,6 +32,9 @@ def process_data(input_file, output_file):
     # Stack to track the currently running tasks
     active_tasks = []
 
+    # Events lost on the target, as reported by its loss records
+    lost_events = 0
+
     # Open the CSV file for reading
     with open(input_file, mode='r') as csvfile:
         csvreader = csv.reader(csvfile)
@@ -32,6 +42,14 @@ def process_data(input_file, output_file):
         # Add lines to the logging to model preemption
         for row in csvreader:
             task_n = int(row[0])  # Extract task number as integer
+            # Loss records (event 2) stand for row[0] events the target had to drop,
+            # the other events come from the kernel trace hooks or the deadline
+            # watchdog: skip them, except an aborted job (16) which ends like a completion.
+            if row[1] == '2':
+                lost_events += task_n
+                continue
+            if row[1] not in ('0', '1', '16'):
+                continue
             phase = 'B' if row[1] == '1' else 'E'  # Convert phase
             timestamp = int(row[2])  # Convert timestamp to integer
 
@@ -95,20 +113,27 @@ def process_data(input_file, output_file):
             "ph": phase,
             "pid": task_n,
             "tid": f"task{task_n}",
-            "ts": timestamp * 1000
+            "ts": timestamp * timestamp_scale
         })
 
     # Write the JSON data to the output file
     with open(output_file, mode='w') as jsonfile:
         json.dump(json_data, jsonfile, indent=4)
 
+    if lost_events > 0:
+        print("WARNING: the trace reports " + str(lost_events) + " lost events, the tasks around the gaps may look wrong")
+
 # process parameters
-if len(sys.argv) > 1:
-        input_file = sys.argv[1]
-        if len(sys.argv) > 2:
-            output_file = sys.argv[2]
+args = sys.argv[1:]
+if '--ms' in args:
+    args.remove('--ms')
+    timestamp_scale = 1000
+if len(args) > 0:
+        input_file = args[0]
+        if len(args) > 1:
+            output_file = args[1]
 
 # Run the process
-process_data(input_file, output_file)
+process_data(input_file, output_file, timestamp_scale)
 
 print(f"Data processed and written to {output_file}")
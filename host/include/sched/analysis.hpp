@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "sched/task.hpp"
+
+namespace sched {
+
+// response time that exceeds every bound (the analysis gave up)
+constexpr uint64_t kUnbounded = UINT64_MAX;
+
+// total utilization sum(C/T)
+double utilization(const Task* tasks, size_t count);
+
+// least common multiple of the periods, kUnbounded if it does not fit in 64 bits
+uint64_t hyperperiod(const Task* tasks, size_t count);
+
+// Exact worst-case response time of every task under preemptive fixed-priority
+// scheduling on one processor (Joseph & Pandya, with Lehoczky's level-i busy
+// period for deadlines beyond the period, and Tindell's release jitter). Tasks
+// of equal priority are assumed to interfere with each other. `blocking`, if
+// given, adds a blocking term per task. With `stopAtDeadline` the iteration
+// stops as soon as a response time exceeds its deadline and reports kUnbounded,
+// which is what sweeps need.
+// Returns true if every task meets its deadline.
+bool responseTimeAnalysis(const Task* tasks, size_t count, uint64_t* responseTimes,
+                          const uint64_t* blocking = nullptr, bool stopAtDeadline = false);
+
+// Exact EDF test on one processor: processor demand analysis, evaluated with
+// Quick convergence Processor-demand Analysis (Zhang & Burns, 2009).
+bool edfSchedulable(const Task* tasks, size_t count);
+
+// Largest budget of `server` (its period as given) with which `tasks` stay
+// schedulable under fixed priority, the server above all of them: how much
+// aperiodic work the task set leaves room for. `blocking`, if given, are the
+// blocking terms of `tasks` (the server uses no resource). kUnbounded if `tasks`
+// are not schedulable even with an empty server.
+uint64_t maxServerBudget(const TaskSet& tasks, Server server, const uint64_t* blocking = nullptr);
+
+inline double utilization(const TaskSet& tasks) {
+    return utilization(tasks.data(), tasks.size());
+}
+inline uint64_t hyperperiod(const TaskSet& tasks) {
+    return hyperperiod(tasks.data(), tasks.size());
+}
+inline bool edfSchedulable(const TaskSet& tasks) {
+    return edfSchedulable(tasks.data(), tasks.size());
+}
+
+} // namespace sched
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "sched/task.hpp"
+
+namespace sched {
+
+struct GeneratorConfig {
+    uint32_t tasks = 8;
+    double utilization = 0.7;
+    // periods are drawn log-uniformly from [periodMin, periodMax] and rounded
+    // down to a multiple of `granularity` (the 1 ms tick by default)
+    uint64_t periodMin = 1000;
+    uint64_t periodMax = 100000;
+    uint64_t granularity = 1000;
+    // relative deadlines are drawn uniformly from [C + ratio * (T - C), T];
+    // 1 gives implicit deadlines
+    double deadlineRatioMin = 1.0;
+};
+
+// Random periodic task sets with UUniFast utilizations (Bini & Buttazzo, 2005),
+// no task above 1 when the total is above 1.
+// Priorities are left at 0, use assignPriorities() on the result.
+class TaskSetGenerator {
+public:
+    explicit TaskSetGenerator(uint64_t seed) : random_(seed) {}
+
+    // fill `tasks` with a new set (reusing its storage)
+    void generate(const GeneratorConfig& config, TaskSet& tasks);
+
+private:
+    std::mt19937_64 random_;
+    std::vector<double> utilizations_;
+};
+
+} // namespace sched
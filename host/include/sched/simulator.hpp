@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "sched/task.hpp"
+#include "trace/decoder.hpp"
+
+namespace sched {
+
+enum class SimPolicy {
+    // preemptive fixed priority, Task::priority (higher is more urgent)
+    FixedPriority,
+    // preemptive earliest deadline first
+    Edf
+};
+
+enum class SimPlacement {
+    // every task runs on the core given by SimConfig::partition
+    Partitioned,
+    // one ready queue for all cores, the `cores` most urgent jobs run
+    Global
+};
+
+struct SimConfig {
+    SimPolicy policy = SimPolicy::FixedPriority;
+    uint32_t cores = 1;
+    SimPlacement placement = SimPlacement::Partitioned;
+    // core of every task when partitioned; empty: partitionTasks() with
+    // `heuristic`, tested for `policy`
+    std::vector<uint32_t> partition;
+    PartitionHeuristic heuristic = PARTITION_FIRST_FIT_DECREASING;
+    // simulated time in microseconds
+    uint64_t duration = 0;
+    // Once every core is idle at a hyperperiod boundary the schedule repeats
+    // from time 0, so whole hyperperiods are accounted for without simulating
+    // them. Only done when no trace is requested.
+    bool skipSteadyState = true;
+};
+
+struct SimTaskStats {
+    uint64_t jobs = 0;
+    uint64_t missed = 0;
+    uint64_t maxResponse = 0;
+    uint64_t totalResponse = 0;
+};
+
+struct SimStats {
+    // per task, in the order of the task set
+    std::vector<SimTaskStats> tasks;
+    uint64_t jobs = 0;
+    uint64_t missed = 0;
+    uint64_t preemptions = 0;
+    // a job resumed on another core than the one it was preempted on (global)
+    uint64_t migrations = 0;
+    // time covered by the run, simulated or skipped
+    uint64_t simulatedTime = 0;
+    // part of it accounted for by repeating the schedule, not simulated
+    uint64_t skippedTime = 0;
+    // length of the repeating schedule, 0 if none was found
+    uint64_t cycle = 0;
+};
+
+// Discrete-event simulation of a periodic task set released synchronously at
+// time 0, every job executing for exactly its WCET. The jobs of a task run one
+// after the other like the firmware's job loop: a job released while the
+// previous one is still pending waits for it, and a late job runs to completion
+// (counted as a miss). Time only advances from one release or completion to the
+// next, a run costs O(log n) per job.
+class Simulator {
+public:
+    Simulator(const TaskSet& tasks, const SimConfig& config);
+
+    // simulate [0, config.duration); every job start and completion is sent to
+    // `sink` as a JOB_START / JOB_COMPLETION event, like logEvent() on target
+    const SimStats& run(trace::EventSink* sink = nullptr);
+
+    const SimStats& stats() const { return stats_; }
+
+private:
+    struct TaskState {
+        uint64_t released = 0;
+        uint64_t done = 0;
+        uint64_t nextRelease = 0;
+        // execution left to the oldest pending job
+        uint64_t remaining = 0;
+        // the oldest pending job has started executing
+        bool started = false;
+        // core the task last ran on, -1 before its first job
+        int32_t lastCore = -1;
+        uint32_t group = 0;
+    };
+
+    // cores that share a ready queue: one per core when partitioned, one for all
+    // cores when global
+    struct Group {
+        // (key, sequence number) of the ready jobs not running, best first
+        std::vector<std::pair<std::pair<uint64_t, uint64_t>, uint32_t>> ready;
+        std::vector<uint32_t> cores;
+    };
+
+    struct Core {
+        // running task, -1 when idle
+        int32_t task = -1;
+        std::pair<uint64_t, uint64_t> key;
+    };
+
+    void reset();
+    void advance(uint64_t time);
+    void complete(uint32_t core);
+    void release(uint32_t task);
+    void makeReady(uint32_t task);
+    void dispatch(Group& group);
+    void skipCycles(uint64_t end);
+    void emit(uint32_t core, uint32_t task, uint32_t type);
+
+    TaskSet tasks_;
+    SimConfig config_;
+    uint64_t hyperperiod_;
+    std::vector<TaskState> state_;
+    std::vector<Group> groups_;
+    std::vector<Core> cores_;
+    // (release time, task), earliest first
+    std::vector<std::pair<uint64_t, uint32_t>> releases_;
+    uint64_t now_ = 0;
+    uint64_t sequence_ = 0;
+    trace::EventSink* sink_ = nullptr;
+    SimStats stats_;
+};
+
+} // namespace sched
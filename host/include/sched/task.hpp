@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "utils/aperiodicServer.h"
+#include "utils/resourceSet.h"
+#include "utils/systemTasks.h"
+#include "utils/taskSet.h"
+
+namespace sched {
+
+// a periodic task for the host-side analyses, times in microseconds
+struct Task {
+    uint32_t id = 0;
+    uint64_t period = 0;
+    // relative deadline
+    uint64_t deadline = 0;
+    uint64_t wcet = 0;
+    // fixed priority, higher value means more urgent
+    uint32_t priority = 0;
+    // release jitter: the jobs may be released up to this much after the
+    // period boundary (only the response-time analysis takes it into account)
+    uint64_t jitter = 0;
+};
+
+using TaskSet = std::vector<Task>;
+
+// the task table of one mode compiled into the firmware (modeTable.c, mode 0
+// is taskTable.c), with priorities assigned the way createPeriodicTasks() does
+TaskSet firmwareTaskSet(PriorityPolicy policy, uint32_t mode = 0);
+
+// assign priorities to `tasks` with the firmware's rules (taskSetAssignPriorities)
+void assignPriorities(TaskSet& tasks, PriorityPolicy policy);
+
+// Pin every task to one of `cores` cores with the firmware's assigner
+// (taskSetPartition): fixed-priority response-time analysis on the priorities
+// of `tasks`, or the EDF density test with `edf`. Returns false if some task
+// fit nowhere.
+bool partitionTasks(const TaskSet& tasks, uint32_t cores, PartitionHeuristic heuristic, bool edf,
+                    std::vector<uint32_t>& partition);
+
+// parse a partitioning heuristic name: ffd (first fit) or wfd (worst fit)
+bool parseHeuristic(const std::string& name, PartitionHeuristic& heuristic);
+
+// Read a task set from a CSV file with one `id,period,deadline,wcet[,priority]`
+// line per task (microseconds); lines starting with '#' are comments. Returns
+// false and sets `error` if the file cannot be read or parsed.
+bool loadTaskSet(const std::string& path, TaskSet& tasks, std::string& error);
+
+// parse a priority policy name: rm, dm or explicit
+bool parsePolicy(const std::string& name, PriorityPolicy& policy);
+
+// the firmware's aperiodic server (aperiodicServer.h), by default as configured there
+struct Server {
+    // APERIODIC_SERVER_POLLING, APERIODIC_SERVER_DEFERRABLE or APERIODIC_SERVER_SPORADIC
+    uint32_t policy = APERIODIC_SERVER_POLICY;
+    uint64_t budget = APERIODIC_SERVER_BUDGET_US;
+    uint64_t period = APERIODIC_SERVER_PERIOD_US;
+};
+
+// The server as a task of the analysis, above every task of `tasks`: its budget
+// as wcet every period. The deferrable server can use the budget of one period
+// at its very end and that of the next one at once, which is a release jitter
+// of period - budget.
+Task serverTask(const Server& server, const TaskSet& tasks);
+
+// The firmware's tasks above the server (systemTasks.h), the console and the
+// timer service task, as periodic tasks of their bounded cost, in that order
+// above `server`.
+TaskSet systemTasks(const Task& server);
+
+// parse a server policy name: polling, deferrable or sporadic
+bool parseServerPolicy(const std::string& name, uint32_t& policy);
+
+// name of a server policy
+const char* serverPolicyName(uint32_t policy);
+
+// a resource shared by tasks under the immediate priority ceiling protocol
+// (resource.h), times in microseconds
+struct Resource {
+    uint32_t id = 0;
+    // longest critical section on it
+    uint64_t hold = 0;
+    // ids of the tasks using it
+    std::vector<uint32_t> users;
+};
+
+using ResourceSet = std::vector<Resource>;
+
+// the resource table compiled into the firmware (resourceTable.c)
+ResourceSet firmwareResources();
+
+// Read resources from a CSV file with one `id,hold,user[,user...]` line per
+// resource (microseconds, task ids), at most RESOURCE_MAX_USERS users each;
+// lines starting with '#' are comments. Returns false and sets `error` if the
+// file cannot be read or parsed.
+bool loadResources(const std::string& path, ResourceSet& resources, std::string& error);
+
+// Blocking term of every task of `tasks` (those of one core) under the ceiling
+// protocol with the firmware's rule (resourceBlocking): the longest critical
+// section of a lower task on a resource whose ceiling reaches its priority.
+std::vector<uint64_t> blockingTerms(const TaskSet& tasks, const ResourceSet& resources);
+
+} // namespace sched
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "trace/decoder.hpp"
+#include "utils/latencyHistogram.h"
+
+namespace trace {
+
+// what the analysis knows about a task of the trace, times in microseconds
+struct TaskBound {
+    uint32_t id = 0;
+    uint64_t period = 0;
+    uint64_t deadline = 0;
+    // worst-case response time from the analysis, UINT64_MAX if there is none
+    uint64_t wcrt = UINT64_MAX;
+};
+
+// one job rebuilt from its start and completion events
+struct Job {
+    uint32_t core;
+    uint32_t taskNum;
+    // number of the job in its task, from 0
+    uint64_t index;
+    // inferred, see JobAnalyzer; equal to `start` for tasks without a TaskBound
+    uint64_t release;
+    uint64_t start;
+    uint64_t completion;
+    // times another job started on the core while this one was running
+    uint32_t preemptions;
+    bool met;
+    // the response time is above the analytical worst case
+    bool exceedsBound;
+    // stopped by the deadline watchdog (MISS_ABORT): `completion` is when, the
+    // job is counted as missed
+    bool aborted;
+};
+
+class JobSink {
+public:
+    virtual ~JobSink() = default;
+    virtual void onJob(const Job& job) = 0;
+};
+
+struct TaskSummary {
+    uint32_t taskNum = 0;
+    // the task has a TaskBound (the logging task, for one, has none)
+    bool known = false;
+    uint64_t jobs = 0;
+    uint64_t missed = 0;
+    uint64_t exceeded = 0;
+    // deadline watchdog: jobs stopped, releases dropped
+    uint64_t aborted = 0;
+    uint64_t skipped = 0;
+    uint64_t preemptions = 0;
+    // execution time, the sum of its slices
+    uint64_t cpuTime = 0;
+    uint64_t maxResponse = 0;
+    // response times, microseconds
+    LatencyHistogram response;
+};
+
+struct AnalyticsSummary {
+    // in order of task number
+    std::vector<TaskSummary> tasks;
+    uint64_t firstTimestamp = 0;
+    uint64_t lastTimestamp = 0;
+    uint32_t cores = 0;
+    // time with at least one job active, summed over the cores
+    uint64_t busyTime = 0;
+    // maximal intervals with a job active on a core
+    uint64_t busyPeriods = 0;
+    uint64_t longestBusyPeriod = 0;
+    uint64_t jobs = 0;
+    uint64_t missed = 0;
+    uint64_t exceeded = 0;
+    uint64_t aborted = 0;
+    uint64_t skipped = 0;
+    // events the target reported lost (loss records)
+    uint64_t lostEvents = 0;
+    // start of an active task or completion of a task not running on its core
+    uint64_t anomalies = 0;
+    // jobs still running at the end of the trace
+    uint64_t openJobs = 0;
+    // operating modes started (MODE_CHANGED)
+    uint64_t modeChanges = 0;
+
+    uint64_t span() const { return lastTimestamp - firstTimestamp; }
+};
+
+// Rebuilds every job of a trace of job start / completion events (logEvent())
+// and accounts for it per task and per core, in one pass and with memory
+// proportional to the number of tasks.
+//
+// A job runs from its start to its completion, and on its core it is preempted
+// by every job that starts in between, like in data_proc.py. The release of a
+// job is not in the trace: the tasks are assumed to be released together at
+// the first job start of the trace, then every period (xTaskDelayUntil()), so
+// job k of a task is released at phase + k * period. After lost events the
+// job count of the tasks of that core is recovered from the start time, and a
+// release dropped by the deadline watchdog (JOB_SKIPPED) moves it on by one.
+// A job aborted by the watchdog (JOB_ABORTED) ends there as a missed one, without
+// a response time. A mode change (MODE_CHANGED) releases the tasks together
+// again at its timestamp, and the job count of every task is recovered from
+// there; the bounds stay those of one mode, so the jobs of the other modes are
+// judged against them. Kernel events are ignored.
+class JobAnalyzer : public EventSink {
+public:
+    // `timestampScale` converts the trace timestamps to microseconds
+    JobAnalyzer(const std::vector<TaskBound>& bounds, uint64_t timestampScale = 1, JobSink* jobs = nullptr);
+
+    void onEvent(const Event& event) override;
+    void finish() override;
+
+    const AnalyticsSummary& summary() const { return summary_; }
+
+private:
+    struct TaskState {
+        size_t summary;
+        const TaskBound* bound = nullptr;
+        bool active = false;
+        // the job count is to be recovered at the next start
+        bool resync = false;
+        Job job;
+        uint64_t nextRelease = 0;
+        uint64_t nextIndex = 0;
+    };
+
+    struct CoreState {
+        // active tasks, the running one last
+        std::vector<TaskState*> stack;
+        // start of the running slice, and of the busy period
+        uint64_t sliceStart = 0;
+        uint64_t busyStart = 0;
+    };
+
+    TaskState& task(uint32_t taskNum);
+    CoreState& core(uint32_t core);
+    void start(const Event& event, uint64_t timestamp);
+    void complete(const Event& event, uint64_t timestamp, bool aborted);
+    void skip(const Event& event);
+    // take `state` off its core's stack at `timestamp`, accounting for its last slice
+    void remove(TaskState& state, uint64_t timestamp);
+
+    std::vector<TaskBound> bounds_;
+    uint64_t timestampScale_;
+    JobSink* jobs_;
+    bool started_ = false;
+    bool seenEvent_ = false;
+    uint64_t phase_ = 0;
+    std::unordered_map<uint32_t, TaskState> tasks_;
+    std::vector<CoreState> cores_;
+    AnalyticsSummary summary_;
+};
+
+} // namespace trace
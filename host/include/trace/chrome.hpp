@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "trace/preemption.hpp"
+
+namespace trace {
+
+// Writes slices as a Chrome trace / Perfetto JSON array, incrementally and in
+// compact form. By default every task is its own track, exactly like the output
+// of data_proc.py; with `perCore` there is one track per core instead, showing
+// which task ran where.
+class ChromeJsonWriter : public SliceSink {
+public:
+    // `timestampScale` converts trace timestamps into the microseconds of the
+    // JSON "ts" field (1 for current traces, 1000 for millisecond captures)
+    ChromeJsonWriter(std::FILE* out, bool perCore, uint64_t timestampScale = 1);
+    ~ChromeJsonWriter() override;
+
+    void onSlice(const Slice& slice) override;
+    void finish() override;
+
+private:
+    // the constant text of the events of one track, around the phase character
+    struct Track {
+        std::string prefix;
+        std::string suffix;
+    };
+
+    const Track& trackOf(const Slice& slice);
+    void append(const char* text, size_t length);
+    void flush();
+
+    std::FILE* out_;
+    bool perCore_;
+    uint64_t timestampScale_;
+    bool first_ = true;
+    bool finished_ = false;
+    std::vector<bool> namedCores_;
+    std::vector<Track> tracks_;
+    std::vector<char> buffer_;
+    size_t used_ = 0;
+};
+
+} // namespace trace
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+#include "trace/decoder.hpp"
+
+namespace trace {
+
+// Writes events in the `task,event,timestamp` layout of the firmware's CSV dumps
+// (and of RM.csv), optionally followed by the core as a fourth column.
+class CsvWriter : public EventSink {
+public:
+    explicit CsvWriter(std::FILE* out, bool withCore = false);
+    ~CsvWriter() override;
+
+    void onEvent(const Event& event) override;
+    void finish() override;
+
+private:
+    void flush();
+
+    std::FILE* out_;
+    bool withCore_;
+    std::vector<char> buffer_;
+    size_t used_ = 0;
+};
+
+// Streaming parser of the `task,event,timestamp[,core]` layout. Lines that do
+// not parse (dump markers, console output) are counted and skipped. The input
+// can be fed in chunks of any size.
+class CsvReader {
+public:
+    explicit CsvReader(EventSink& sink);
+
+    void feed(const char* data, size_t length);
+    // end of stream: parse a last line without newline
+    void finish();
+
+    uint64_t lines() const { return lines_; }
+    uint64_t skippedLines() const { return skippedLines_; }
+
+private:
+    void parseLine(const char* begin, const char* end);
+
+    EventSink& sink_;
+    std::vector<char> carry_;
+    uint64_t lines_ = 0;
+    uint64_t skippedLines_ = 0;
+};
+
+} // namespace trace
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace trace {
+
+// one decoded trace event, `type` holds the firmware's EventType value
+struct Event {
+    uint32_t core;
+    uint32_t taskNum;
+    uint32_t type;
+    uint64_t timestamp;
+};
+
+// receiver of decoded events, the decoding stages are chained through it
+class EventSink {
+public:
+    virtual ~EventSink() = default;
+    virtual void onEvent(const Event& event) = 0;
+    // called once at the end of the stream
+    virtual void finish() {}
+};
+
+struct DecoderStats {
+    uint64_t bytes = 0;
+    uint64_t frames = 0;
+    uint64_t records = 0;
+    // bytes outside of any valid frame (console text, line noise, torn frames)
+    uint64_t skippedBytes = 0;
+    uint64_t crcErrors = 0;
+    // gaps in the per-core frame sequence numbers
+    uint64_t lostFrames = 0;
+    // frames whose body did not decode into whole records
+    uint64_t badFrames = 0;
+    // loss records (TRACE_EVENT_LOST) among `records`, and the events they stand for
+    uint64_t lossRecords = 0;
+    uint64_t lostEvents = 0;
+};
+
+// Incremental decoder of the framed binary stream described in
+// utils/traces/traceFormat.h. The stream can be fed in chunks of any size; it
+// resynchronises on the sync bytes, so console text interleaved with the frames
+// and corrupted frames are skipped and counted instead of stopping the decoding.
+class FrameDecoder {
+public:
+    explicit FrameDecoder(EventSink& sink);
+
+    void feed(const uint8_t* data, size_t length);
+    // end of stream: a trailing incomplete frame is counted as skipped
+    void finish();
+
+    const DecoderStats& stats() const { return stats_; }
+
+private:
+    // decode as many frames as possible from `data`, returns the bytes consumed
+    size_t parse(const uint8_t* data, size_t length);
+    bool decodeBody(uint32_t core, const uint8_t* body, size_t length);
+
+    EventSink& sink_;
+    std::vector<uint8_t> carry_;
+    std::vector<Event> frameEvents_;
+    // last sequence number seen per core, -1 before the first frame
+    std::array<int32_t, 256> lastSeq_;
+    DecoderStats stats_;
+};
+
+// Merges the per-core event streams back into a single stream ordered by
+// timestamp, buffering only until every core has an event pending. The firmware
+// drains the cores one after the other, so the merge has to know up front how
+// many there are (configNUM_CORES); a core that stays silent only delays the
+// others up to `maxBuffered` events.
+class CoreMerger : public EventSink {
+public:
+    explicit CoreMerger(EventSink& sink, uint32_t cores = 2, size_t maxBuffered = size_t(1) << 20);
+
+    void onEvent(const Event& event) override;
+    void finish() override;
+
+private:
+    // forward the oldest buffered event
+    void emitOldest();
+
+    EventSink& sink_;
+    size_t maxBuffered_;
+    size_t buffered_ = 0;
+    std::vector<std::deque<Event>> queues_;
+};
+
+} // namespace trace
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "trace/decoder.hpp"
+
+namespace trace {
+
+enum class InputFormat {
+    // binary if the start of the input is not text, CSV otherwise
+    Auto,
+    Csv,
+    Binary
+};
+
+struct InputStats {
+    InputFormat format = InputFormat::Auto;
+    uint64_t bytes = 0;
+    // binary input
+    DecoderStats decoder;
+    // CSV input
+    uint64_t lines = 0;
+    uint64_t skippedLines = 0;
+};
+
+// Reads a whole trace, CSV or framed binary, and passes its events to `sink` in
+// timestamp order (binary streams are merged across `cores`). Regular files are
+// memory-mapped, "-" reads stdin in chunks. Returns false on I/O errors.
+bool readTrace(const std::string& path, InputFormat format, EventSink& sink, InputStats& stats,
+               uint32_t cores = 2);
+
+// print the statistics of `stats` in one line to stderr, prefixed with `label`
+void printInputStats(const char* label, const InputStats& stats);
+
+} // namespace trace
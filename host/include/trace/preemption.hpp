@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "trace/decoder.hpp"
+
+namespace trace {
+
+// one end of an execution slice of a task: phase 'B' when it (re)starts running,
+// 'E' when it completes or gets preempted
+struct Slice {
+    uint32_t core;
+    uint32_t taskNum;
+    char phase;
+    uint64_t timestamp;
+};
+
+class SliceSink {
+public:
+    virtual ~SliceSink() = default;
+    virtual void onSlice(const Slice& slice) = 0;
+    virtual void finish() {}
+};
+
+struct PreemptionStats {
+    uint64_t events = 0;
+    // begin and end events passed on
+    uint64_t slices = 0;
+    uint64_t preemptions = 0;
+    // slices that started and ended at the same timestamp, filtered out
+    uint64_t zeroLength = 0;
+    // completion of a task that is not running on that core
+    uint64_t endWithoutStart = 0;
+    // completion of a task that is active but preempted (the completion of the
+    // task above it is missing)
+    uint64_t endNotRunning = 0;
+    // start of a task whose previous job never completed
+    uint64_t startWhileActive = 0;
+    // slices still open at the end of the trace
+    uint64_t openAtEnd = 0;
+    // kernel switch-in events, each one starts an exact slice
+    uint64_t switches = 0;
+    // loss records (a full ring on target) and the events they stand for
+    uint64_t lossRecords = 0;
+    uint64_t lostEvents = 0;
+
+    uint64_t anomalies() const { return endWithoutStart + endNotRunning + startWhileActive; }
+};
+
+// Rebuilds execution slices from job start/completion events, the way
+// process_data() in data_proc.py does: a job start preempts the running task, a
+// completion resumes the task below it. Zero-length slices and a trailing open
+// slice are dropped like there. Inconsistent events (lost or reordered ones) are
+// counted and repaired instead of stopping the conversion, which keeps every
+// stack bounded by the number of tasks.
+//
+// With `perCore` every core keeps its own stack of active tasks; otherwise all
+// events are treated as one processor.
+//
+// A trace recorded with the kernel trace hooks (TRACE_KERNEL_EVENTS) needs no
+// reconstruction: from the first switch event of a core on, its slices are the
+// switch-in / switch-out pairs and the job events of that core are ignored.
+//
+// Loss records are counted; with `verbose` the first ones are reported with the
+// numbers of the missing events in the stream of their core (traceFormat.h).
+class PreemptionBuilder : public EventSink {
+public:
+    PreemptionBuilder(SliceSink& sink, bool perCore, bool verbose = true);
+
+    void onEvent(const Event& event) override;
+    void finish() override;
+
+    const PreemptionStats& stats() const { return stats_; }
+
+private:
+    struct CoreState {
+        // active tasks, the running one last
+        std::vector<uint32_t> stack;
+        // a begin is held back until we know it is not immediately ended again
+        bool held = false;
+        Slice heldBegin;
+        // the core has kernel switch events, `stack` holds the running task only
+        bool kernel = false;
+    };
+
+    void onSwitch(const Event& event);
+    void onLoss(const Event& event);
+    void emit(CoreState& state, const Slice& slice);
+    void report(const char* what, const Event& event);
+
+    SliceSink& sink_;
+    bool perCore_;
+    bool verbose_;
+    std::vector<CoreState> cores_;
+    // events seen so far on every core (by event.core), loss records count for
+    // the events they stand for
+    std::vector<uint64_t> eventNumbers_;
+    PreemptionStats stats_;
+};
+
+} // namespace trace
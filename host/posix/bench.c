@@ -0,0 +1,26 @@
+// Microbenchmarks of the tracing and kernel primitives (utils/benchmark.h) on the
+// FreeRTOS POSIX port, for a plain Linux box:
+//
+//   rts_posix_bench_csv > bench.csv
+//   rts_posix_bench_json > bench.json
+//
+// The timings are in nanoseconds of the host and include the port's thread
+// switching, compare them between commits on the same machine only.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "utils/benchmark.h"
+
+static void benchmarkDone(void) {
+    fflush(stdout);
+    exit(0);
+}
+
+int main(void) {
+    createBenchmarkTask(benchmarkDone);
+    vTaskStartScheduler();
+    return 1;
+}
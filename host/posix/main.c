@@ -0,0 +1,122 @@
+// Entry point of the FreeRTOS POSIX build: runs the periodic tasks of
+// taskTable.c with the firmware's job loop and logger for a fixed time, then
+// dumps the log to stdout and prints the deadline statistics to stderr.
+//
+//   rts_posix_fp [seconds] [periodic|aperiodic|modes] [percent] > fp.csv
+//   rts_posix_edf [seconds] [periodic|aperiodic|modes] [percent] > edf.csv
+//   rts_posix_alarm [seconds] [periodic|aperiodic|modes] [percent] > alarm.csv
+//
+// The log has the layout of RM.csv (with microsecond timestamps), to be fed to
+// trace2json like a firmware trace. With `aperiodic` the background load of
+// highPrioTask.h is submitted to the aperiodic server meanwhile. With `modes`
+// the run goes through every mode of modeTable.c and back to the first, in
+// equal parts, and the latency of each change is printed. `percent` stretches
+// every execution time (workloadSetScale()), which is how sweep.py looks for
+// the breakdown utilization of the task set on this scheduler.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "utils/traces/traces.h"
+#include "utils/periodicTask.h"
+#include "utils/workload.h"
+#include "utils/aperiodicServer.h"
+#include "utils/highPrioTask.h"
+#include <string.h>
+
+#define RUN_SECONDS_DEFAULT 3
+
+static uint32_t runSeconds = RUN_SECONDS_DEFAULT;
+
+// requests the mode changes of a `modes` run: above every periodic task
+static void vModeTask(void *pvParameters) {
+    (void)pvParameters;
+    TickType_t part = pdMS_TO_TICKS(runSeconds * 1000 / (taskModeCount + 1));
+    for (uint32_t i = 1; i <= taskModeCount; i++) {
+        vTaskDelay(part);
+        uint32_t mode = i % taskModeCount;
+        uint32_t changes = getModeChangeStats()->changes;
+        if (!requestModeChange(mode)) {
+            fprintf(stderr, "Mode change to %s refused\n", taskModes[mode].name);
+            continue;
+        }
+        while (getModeChangeStats()->changes == changes) {
+            vTaskDelay(1);
+        }
+        fprintf(stderr, "Mode %s started %u us after the request\n", taskModes[mode].name,
+                (unsigned)getModeChangeStats()->lastLatencyUs);
+    }
+    vTaskDelete(NULL);
+}
+
+// ends the run: above every periodic task
+static void vStopTask(void *pvParameters) {
+    (void)pvParameters;
+    vTaskDelay(pdMS_TO_TICKS(runSeconds * 1000));
+    // the logging task preempts us and dumps whatever is left in the ring
+    flushLogger();
+    // the statistics start over with every mode
+    const TaskMode *mode = getCurrentMode();
+    fprintf(stderr, "Mode %s\n", mode->name);
+    for (uint32_t i = 0; i < mode->count; i++) {
+        const TaskStats *stats = getPeriodicTaskStats(i);
+        fprintf(stderr, "Task %u: %u met, %u missed", (unsigned)mode->tasks[i].id,
+                (unsigned)stats->met, (unsigned)stats->missed);
+#if PERIODIC_RELEASE == PERIODIC_RELEASE_ALARM
+        // late by up to a tick here, the alarms are served from the tick hook
+        fprintf(stderr, ", releases late p50 %u us, max %u us",
+                (unsigned)latencyHistogramPercentile(&stats->release, 500), (unsigned)stats->release.max);
+#endif
+        fprintf(stderr, "\n");
+    }
+    LoggerStats logger;
+    getLoggerStats(&logger);
+    fprintf(stderr, "Logger: %u drains, %u records, %u bytes, busy %llu us, max %u us per drain, %u dropped\n",
+            (unsigned)logger.drains, (unsigned)logger.records, (unsigned)logger.bytes,
+            (unsigned long long)logger.busyUs, (unsigned)logger.maxDrainUs, (unsigned)logger.dropped);
+    static AperiodicStats aperiodic;
+    getAperiodicStats(&aperiodic);
+    fprintf(stderr, "Aperiodic: %u submitted, %u served, %u rejected, %u budget waits,"
+            " response p50 %u us, max %u us\n",
+            (unsigned)aperiodic.submitted, (unsigned)aperiodic.served, (unsigned)aperiodic.rejected,
+            (unsigned)aperiodic.budgetExhausted, (unsigned)latencyHistogramPercentile(&aperiodic.response, 500),
+            (unsigned)aperiodic.response.max);
+    fflush(stdout);
+    exit(0);
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        runSeconds = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+    bool aperiodicLoad = argc > 2 && strcmp(argv[2], "aperiodic") == 0;
+    bool modeChanges = argc > 2 && strcmp(argv[2], "modes") == 0;
+    uint32_t scalePercent = argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 10) : 100;
+    fprintf(stderr, "Running %s scheduling for %u s\n",
+            PERIODIC_SCHEDULING == PERIODIC_SCHED_EDF ? "EDF" : "fixed-priority", (unsigned)runSeconds);
+    double utilization = 0;
+    for (uint32_t i = 0; i < taskSetSize; i++) {
+        utilization += (double)taskSet[i].wcetUs / taskSet[i].periodUs;
+    }
+    fprintf(stderr, "Execution times at %u%%: utilization %.4f\n", (unsigned)scalePercent,
+            utilization * scalePercent / 100);
+
+    workloadCalibrate();
+    fprintf(stderr, "Workload calibrated: %u loops/ms\n", (unsigned)workloadLoopsPerMs());
+    workloadSetScale(scalePercent);
+    initLogger();
+    createPeriodicTasks();
+    createAperiodicServer();
+    if (aperiodicLoad) {
+        addHighPriorityTask();
+    }
+    if (modeChanges) {
+        xTaskCreate(vModeTask, "Modes", configMINIMAL_STACK_SIZE * 4, NULL, configMAX_PRIORITIES - 3, NULL);
+    }
+    xTaskCreate(vStopTask, "Stop", configMINIMAL_STACK_SIZE * 4, NULL, configMAX_PRIORITIES - 2, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
+
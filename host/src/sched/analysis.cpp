@@ -0,0 +1,245 @@
+#include "sched/analysis.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace sched {
+
+namespace {
+
+// utilization within this distance of 1 counts as exactly 1
+constexpr double kUtilizationEpsilon = 1e-12;
+
+uint64_t ceilDiv(uint64_t a, uint64_t b) {
+    return (a + b - 1) / b;
+}
+
+// demand bound function: execution that must complete within [0, t]
+uint64_t demand(const Task* tasks, size_t count, uint64_t t) {
+    uint64_t h = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (t >= tasks[i].deadline) {
+            h += ((t - tasks[i].deadline) / tasks[i].period + 1) * tasks[i].wcet;
+        }
+    }
+    return h;
+}
+
+// latest absolute deadline strictly before t (0 if there is none)
+uint64_t lastDeadlineBefore(const Task* tasks, size_t count, uint64_t t) {
+    uint64_t latest = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (t > tasks[i].deadline) {
+            uint64_t d = (t - tasks[i].deadline - 1) / tasks[i].period * tasks[i].period + tasks[i].deadline;
+            latest = std::max(latest, d);
+        }
+    }
+    return latest;
+}
+
+// length of the synchronous busy period, kUnbounded if it exceeds `limit`
+uint64_t busyPeriod(const Task* tasks, size_t count, uint64_t limit) {
+    uint64_t w = 0;
+    for (size_t i = 0; i < count; i++) {
+        w += tasks[i].wcet;
+    }
+    for (;;) {
+        uint64_t next = 0;
+        for (size_t i = 0; i < count; i++) {
+            next += ceilDiv(w, tasks[i].period) * tasks[i].wcet;
+        }
+        if (next == w) {
+            return w;
+        }
+        if (next > limit) {
+            return kUnbounded;
+        }
+        w = next;
+    }
+}
+
+} // namespace
+
+double utilization(const Task* tasks, size_t count) {
+    double u = 0;
+    for (size_t i = 0; i < count; i++) {
+        u += static_cast<double>(tasks[i].wcet) / static_cast<double>(tasks[i].period);
+    }
+    return u;
+}
+
+uint64_t hyperperiod(const Task* tasks, size_t count) {
+    uint64_t h = 1;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t g = std::gcd(h, tasks[i].period);
+        uint64_t factor = tasks[i].period / g;
+        if (h > UINT64_MAX / factor) {
+            return kUnbounded;
+        }
+        h *= factor;
+    }
+    return h;
+}
+
+bool responseTimeAnalysis(const Task* tasks, size_t count, uint64_t* responseTimes,
+                          const uint64_t* blocking, bool stopAtDeadline) {
+    bool schedulable = true;
+    for (size_t i = 0; i < count; i++) {
+        const Task& task = tasks[i];
+        uint64_t b = blocking != nullptr ? blocking[i] : 0;
+
+        // utilization of the tasks that can delay task i, itself included: if it
+        // exceeds 1 the busy period never ends
+        double u = 0;
+        for (size_t j = 0; j < count; j++) {
+            if (tasks[j].priority >= task.priority) {
+                u += static_cast<double>(tasks[j].wcet) / static_cast<double>(tasks[j].period);
+            }
+        }
+        if (u > 1 + kUtilizationEpsilon) {
+            responseTimes[i] = kUnbounded;
+            schedulable = false;
+            continue;
+        }
+
+        // examine the jobs of the level-i busy period one after the other
+        uint64_t worst = 0;
+        uint64_t w = b + task.wcet;
+        for (uint64_t q = 0;; q++) {
+            // completion time of job q, counted from the start of the busy period;
+            // jitter makes the release of job q up to `jitter` later than q periods
+            uint64_t limit = kUnbounded;
+            if (stopAtDeadline) {
+                uint64_t due = q * task.period + task.deadline;
+                limit = due > task.jitter ? due - task.jitter : 0;
+            }
+            for (;;) {
+                uint64_t next = b + (q + 1) * task.wcet;
+                for (size_t j = 0; j < count; j++) {
+                    if (j != i && tasks[j].priority >= task.priority) {
+                        // a jittered task can fit one more job into the window
+                        next += ceilDiv(w + tasks[j].jitter, tasks[j].period) * tasks[j].wcet;
+                    }
+                }
+                if (next == w || next > limit) {
+                    w = next;
+                    break;
+                }
+                w = next;
+            }
+            if (w > limit) {
+                worst = kUnbounded;
+                break;
+            }
+            worst = std::max(worst, w + task.jitter - q * task.period);
+            // the busy period ends before the next release: no later job can be worse
+            if (w + task.jitter <= (q + 1) * task.period) {
+                break;
+            }
+            w += task.wcet;
+        }
+        responseTimes[i] = worst;
+        if (worst == kUnbounded || worst > task.deadline) {
+            schedulable = false;
+            if (stopAtDeadline) {
+                for (size_t k = i + 1; k < count; k++) {
+                    responseTimes[k] = kUnbounded;
+                }
+                return false;
+            }
+        }
+    }
+    return schedulable;
+}
+
+bool edfSchedulable(const Task* tasks, size_t count) {
+    if (count == 0) {
+        return true;
+    }
+    double u = utilization(tasks, count);
+    if (u > 1 + kUtilizationEpsilon) {
+        return false;
+    }
+
+    uint64_t minDeadline = UINT64_MAX;
+    uint64_t maxDeadline = 0;
+    bool implicit = true;
+    for (size_t i = 0; i < count; i++) {
+        minDeadline = std::min(minDeadline, tasks[i].deadline);
+        maxDeadline = std::max(maxDeadline, tasks[i].deadline);
+        implicit = implicit && tasks[i].deadline >= tasks[i].period;
+    }
+    // deadlines at or after the period: the utilization bound is exact
+    if (implicit) {
+        return true;
+    }
+
+    // demand only needs checking up to the smaller of the two classic bounds
+    uint64_t bound = kUnbounded;
+    if (u < 1 - kUtilizationEpsilon) {
+        double la = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (tasks[i].period > tasks[i].deadline) {
+                double ui = static_cast<double>(tasks[i].wcet) / static_cast<double>(tasks[i].period);
+                la += static_cast<double>(tasks[i].period - tasks[i].deadline) * ui;
+            }
+        }
+        la = std::max(static_cast<double>(maxDeadline), la / (1 - u));
+        bound = la < 1.8e19 ? static_cast<uint64_t>(la) + 1 : kUnbounded;
+    }
+    uint64_t hyper = hyperperiod(tasks, count);
+    uint64_t lb = busyPeriod(tasks, count, std::min(bound, hyper));
+    bound = std::min({bound, lb, hyper == kUnbounded ? kUnbounded : hyper + maxDeadline});
+    if (bound == kUnbounded) {
+        return false;
+    }
+
+    // QPA: walk the deadlines backwards from the bound, jumping to h(t) when possible
+    uint64_t t = lastDeadlineBefore(tasks, count, bound + 1);
+    uint64_t h = demand(tasks, count, t);
+    while (h <= t && h > minDeadline) {
+        t = h < t ? h : lastDeadlineBefore(tasks, count, t);
+        h = demand(tasks, count, t);
+    }
+    return h <= minDeadline;
+}
+
+uint64_t maxServerBudget(const TaskSet& tasks, Server server, const uint64_t* blocking) {
+    // the tasks above the server interfere with all of them
+    TaskSet withServer = tasks;
+    withServer.push_back(serverTask(server, tasks));
+    size_t serverIndex = withServer.size() - 1;
+    for (const Task& task : systemTasks(withServer.back())) {
+        withServer.push_back(task);
+    }
+    std::vector<uint64_t> responseTimes(withServer.size());
+    std::vector<uint64_t> blockingWithServer(withServer.size(), 0);
+    if (blocking != nullptr) {
+        std::copy(blocking, blocking + tasks.size(), blockingWithServer.begin());
+    }
+    // schedulability only gets lost as the budget grows: bisect over [0, period]
+    uint64_t low = 0;
+    uint64_t high = server.period + 1;
+    while (high - low > 1) {
+        server.budget = low + (high - low) / 2;
+        withServer[serverIndex] = serverTask(server, tasks);
+        if (responseTimeAnalysis(withServer.data(), withServer.size(), responseTimes.data(),
+                                 blockingWithServer.data(), true)) {
+            low = server.budget;
+        } else {
+            high = server.budget;
+        }
+    }
+    if (low == 0) {
+        server.budget = 0;
+        withServer[serverIndex] = serverTask(server, tasks);
+        if (!responseTimeAnalysis(withServer.data(), withServer.size(), responseTimes.data(),
+                                  blockingWithServer.data(), true)) {
+            return kUnbounded;
+        }
+    }
+    return low;
+}
+
+} // namespace sched
@@ -0,0 +1,47 @@
+#include "sched/generator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sched {
+
+void TaskSetGenerator::generate(const GeneratorConfig& config, TaskSet& tasks) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    tasks.resize(config.tasks);
+
+    // UUniFast: split the utilization without biasing any task. Above a total of
+    // 1 (several cores) a task could get more than one core's worth, such draws
+    // are discarded (UUniFast-Discard, Davis & Burns, 2009)
+    utilizations_.resize(config.tasks);
+    do {
+        double remaining = config.utilization;
+        for (uint32_t i = 0; i < config.tasks; i++) {
+            double u = remaining;
+            if (i + 1 < config.tasks) {
+                double next = remaining * std::pow(unit(random_), 1.0 / static_cast<double>(config.tasks - i - 1));
+                u = remaining - next;
+                remaining = next;
+            }
+            utilizations_[i] = u;
+        }
+    } while (config.utilization < config.tasks &&
+             std::any_of(utilizations_.begin(), utilizations_.end(), [](double u) { return u > 1.0; }));
+
+    double logMin = std::log(static_cast<double>(config.periodMin));
+    double logMax = std::log(static_cast<double>(config.periodMax));
+    for (uint32_t i = 0; i < config.tasks; i++) {
+        double u = utilizations_[i];
+        Task& task = tasks[i];
+        task.id = i + 1;
+        uint64_t period = static_cast<uint64_t>(std::exp(logMin + (logMax - logMin) * unit(random_)));
+        period = std::max(config.granularity, period / config.granularity * config.granularity);
+        task.period = period;
+        task.wcet = std::max<uint64_t>(1, static_cast<uint64_t>(std::llround(u * static_cast<double>(period))));
+        double ratio = config.deadlineRatioMin + (1.0 - config.deadlineRatioMin) * unit(random_);
+        uint64_t slack = task.period > task.wcet ? task.period - task.wcet : 0;
+        task.deadline = task.wcet + static_cast<uint64_t>(ratio * static_cast<double>(slack));
+        task.priority = 0;
+    }
+}
+
+} // namespace sched
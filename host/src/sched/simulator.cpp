@@ -0,0 +1,255 @@
+#include "sched/simulator.hpp"
+
+#include <algorithm>
+#include <functional>
+
+#include "sched/analysis.hpp"
+
+namespace sched {
+
+namespace {
+
+// EventType values of the firmware (utils/traces/traces.h)
+constexpr uint32_t kJobStart = 1;
+constexpr uint32_t kJobCompletion = 0;
+
+// the ready queues and the release queue are min-heaps
+template <typename T>
+void heapPush(std::vector<T>& heap, const T& value) {
+    heap.push_back(value);
+    std::push_heap(heap.begin(), heap.end(), std::greater<T>());
+}
+
+template <typename T>
+T heapPop(std::vector<T>& heap) {
+    std::pop_heap(heap.begin(), heap.end(), std::greater<T>());
+    T value = heap.back();
+    heap.pop_back();
+    return value;
+}
+
+} // namespace
+
+Simulator::Simulator(const TaskSet& tasks, const SimConfig& config)
+    : tasks_(tasks), config_(config), hyperperiod_(hyperperiod(tasks)) {
+    config_.cores = std::max<uint32_t>(config_.cores, 1);
+    if (config_.placement == SimPlacement::Partitioned && config_.partition.size() != tasks_.size()) {
+        partitionTasks(tasks_, config_.cores, config_.heuristic, config_.policy == SimPolicy::Edf,
+                       config_.partition);
+    }
+}
+
+void Simulator::reset() {
+    now_ = 0;
+    sequence_ = 0;
+    stats_ = SimStats();
+    stats_.tasks.assign(tasks_.size(), SimTaskStats());
+
+    cores_.assign(config_.cores, Core());
+    groups_.clear();
+    if (config_.placement == SimPlacement::Global) {
+        groups_.resize(1);
+        for (uint32_t c = 0; c < config_.cores; c++) {
+            groups_[0].cores.push_back(c);
+        }
+    } else {
+        groups_.resize(config_.cores);
+        for (uint32_t c = 0; c < config_.cores; c++) {
+            groups_[c].cores.push_back(c);
+        }
+    }
+
+    state_.assign(tasks_.size(), TaskState());
+    releases_.clear();
+    for (uint32_t i = 0; i < tasks_.size(); i++) {
+        state_[i].group = config_.placement == SimPlacement::Global ? 0 : config_.partition[i];
+        heapPush(releases_, std::make_pair(uint64_t(0), i));
+    }
+}
+
+const SimStats& Simulator::run(trace::EventSink* sink) {
+    reset();
+    sink_ = sink;
+    const uint64_t end = config_.duration;
+    // next hyperperiod boundary at which to look for an idle system
+    uint64_t boundary = kUnbounded;
+    if (config_.skipSteadyState && sink_ == nullptr && hyperperiod_ < end) {
+        boundary = hyperperiod_;
+    }
+
+    for (;;) {
+        uint64_t next = releases_.empty() ? kUnbounded : releases_.front().first;
+        for (const Core& core : cores_) {
+            if (core.task >= 0) {
+                next = std::min(next, now_ + state_[core.task].remaining);
+            }
+        }
+        if (next >= end) {
+            advance(end);
+            break;
+        }
+        advance(next);
+
+        for (uint32_t c = 0; c < cores_.size(); c++) {
+            if (cores_[c].task >= 0 && state_[cores_[c].task].remaining == 0) {
+                complete(c);
+            }
+        }
+        if (now_ == boundary) {
+            bool idle = std::all_of(state_.begin(), state_.end(),
+                                    [](const TaskState& s) { return s.released == s.done; });
+            if (idle) {
+                skipCycles(end);
+                boundary = kUnbounded;
+            } else {
+                boundary = boundary + hyperperiod_ < end ? boundary + hyperperiod_ : kUnbounded;
+            }
+        }
+        while (!releases_.empty() && releases_.front().first == now_) {
+            release(heapPop(releases_).second);
+        }
+        for (Group& group : groups_) {
+            dispatch(group);
+        }
+    }
+
+    stats_.simulatedTime = end;
+    if (sink_ != nullptr) {
+        sink_->finish();
+    }
+    return stats_;
+}
+
+void Simulator::advance(uint64_t time) {
+    uint64_t elapsed = time - now_;
+    for (const Core& core : cores_) {
+        if (core.task >= 0) {
+            state_[core.task].remaining -= elapsed;
+        }
+    }
+    now_ = time;
+}
+
+void Simulator::complete(uint32_t core) {
+    uint32_t task = static_cast<uint32_t>(cores_[core].task);
+    TaskState& state = state_[task];
+    SimTaskStats& taskStats = stats_.tasks[task];
+    emit(core, task, kJobCompletion);
+
+    uint64_t release = state.done * tasks_[task].period;
+    uint64_t response = now_ - release;
+    taskStats.jobs++;
+    taskStats.totalResponse += response;
+    taskStats.maxResponse = std::max(taskStats.maxResponse, response);
+    stats_.jobs++;
+    if (response > tasks_[task].deadline) {
+        taskStats.missed++;
+        stats_.missed++;
+    }
+
+    state.done++;
+    cores_[core].task = -1;
+    // the next job was released meanwhile, it starts right away
+    if (state.released > state.done) {
+        makeReady(task);
+    }
+}
+
+void Simulator::release(uint32_t task) {
+    TaskState& state = state_[task];
+    state.released++;
+    state.nextRelease += tasks_[task].period;
+    heapPush(releases_, std::make_pair(state.nextRelease, task));
+    if (state.released - state.done == 1) {
+        makeReady(task);
+    }
+}
+
+void Simulator::makeReady(uint32_t task) {
+    TaskState& state = state_[task];
+    state.remaining = tasks_[task].wcet;
+    state.started = false;
+    uint64_t key = config_.policy == SimPolicy::Edf
+                       ? state.done * tasks_[task].period + tasks_[task].deadline
+                       : UINT32_MAX - tasks_[task].priority;
+    // equal keys are served in the order the jobs became ready
+    heapPush(groups_[state.group].ready, std::make_pair(std::make_pair(key, sequence_++), task));
+}
+
+void Simulator::dispatch(Group& group) {
+    while (!group.ready.empty()) {
+        // the core to take: an idle one, else the one running the least urgent job
+        uint32_t target = group.cores[0];
+        for (uint32_t c : group.cores) {
+            if (cores_[c].task < 0) {
+                target = c;
+                break;
+            }
+            if (cores_[c].key > cores_[target].key) {
+                target = c;
+            }
+        }
+        Core& core = cores_[target];
+        if (core.task >= 0 && !(group.ready.front().first < core.key)) {
+            return;
+        }
+        auto next = heapPop(group.ready);
+        if (core.task >= 0) {
+            // preempted, it keeps its key and so its place among equal keys
+            heapPush(group.ready, std::make_pair(core.key, static_cast<uint32_t>(core.task)));
+            stats_.preemptions++;
+        }
+        core.task = static_cast<int32_t>(next.second);
+        core.key = next.first;
+
+        TaskState& state = state_[next.second];
+        if (!state.started) {
+            state.started = true;
+            emit(target, next.second, kJobStart);
+        } else if (state.lastCore != static_cast<int32_t>(target)) {
+            stats_.migrations++;
+        }
+        state.lastCore = static_cast<int32_t>(target);
+    }
+}
+
+void Simulator::skipCycles(uint64_t end) {
+    // nothing is pending at `now_` and every task is released again at it, so
+    // [now_, 2 now_) replays [0, now_)
+    const uint64_t cycle = now_;
+    const uint64_t skipped = (end - now_) / cycle;
+    stats_.cycle = cycle;
+    if (skipped == 0) {
+        return;
+    }
+    for (SimTaskStats& taskStats : stats_.tasks) {
+        taskStats.jobs += skipped * taskStats.jobs;
+        taskStats.missed += skipped * taskStats.missed;
+        taskStats.totalResponse += skipped * taskStats.totalResponse;
+    }
+    stats_.jobs += skipped * stats_.jobs;
+    stats_.missed += skipped * stats_.missed;
+    stats_.preemptions += skipped * stats_.preemptions;
+    stats_.migrations += skipped * stats_.migrations;
+
+    const uint64_t shift = skipped * cycle;
+    stats_.skippedTime = shift;
+    now_ += shift;
+    for (uint32_t i = 0; i < tasks_.size(); i++) {
+        state_[i].released += shift / tasks_[i].period;
+        state_[i].done += shift / tasks_[i].period;
+        state_[i].nextRelease += shift;
+    }
+    // the same shift for every entry keeps the heap ordered
+    for (auto& entry : releases_) {
+        entry.first += shift;
+    }
+}
+
+void Simulator::emit(uint32_t core, uint32_t task, uint32_t type) {
+    if (sink_ != nullptr) {
+        sink_->onEvent(trace::Event{core, tasks_[task].id, type, now_});
+    }
+}
+
+} // namespace sched
@@ -0,0 +1,263 @@
+#include "sched/task.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace sched {
+
+namespace {
+
+TaskDescriptor toDescriptor(const Task& task) {
+    TaskDescriptor descriptor{};
+    descriptor.id = task.id;
+    descriptor.periodUs = static_cast<uint32_t>(task.period);
+    descriptor.deadlineUs = static_cast<uint32_t>(task.deadline);
+    descriptor.wcetUs = static_cast<uint32_t>(task.wcet);
+    descriptor.priority = task.priority;
+    return descriptor;
+}
+
+} // namespace
+
+TaskSet firmwareTaskSet(PriorityPolicy policy, uint32_t mode) {
+    TaskSet tasks;
+    const TaskMode& taskMode = taskModes[mode];
+    for (uint32_t i = 0; i < taskMode.count; i++) {
+        Task task;
+        task.id = taskMode.tasks[i].id;
+        task.period = taskMode.tasks[i].periodUs;
+        task.deadline = taskMode.tasks[i].deadlineUs;
+        task.wcet = taskMode.tasks[i].wcetUs;
+        task.priority = taskMode.tasks[i].priority;
+        tasks.push_back(task);
+    }
+    assignPriorities(tasks, policy);
+    return tasks;
+}
+
+void assignPriorities(TaskSet& tasks, PriorityPolicy policy) {
+    std::vector<TaskDescriptor> descriptors;
+    descriptors.reserve(tasks.size());
+    for (const Task& task : tasks) {
+        descriptors.push_back(toDescriptor(task));
+    }
+    std::vector<uint32_t> priorities(tasks.size());
+    taskSetAssignPriorities(descriptors.data(), static_cast<uint32_t>(descriptors.size()), policy, 1,
+                            priorities.data());
+    for (size_t i = 0; i < tasks.size(); i++) {
+        tasks[i].priority = priorities[i];
+    }
+}
+
+bool partitionTasks(const TaskSet& tasks, uint32_t cores, PartitionHeuristic heuristic, bool edf,
+                    std::vector<uint32_t>& partition) {
+    std::vector<TaskDescriptor> descriptors;
+    std::vector<uint32_t> priorities;
+    descriptors.reserve(tasks.size());
+    for (const Task& task : tasks) {
+        descriptors.push_back(toDescriptor(task));
+        priorities.push_back(task.priority);
+    }
+    partition.resize(tasks.size());
+    return taskSetPartition(descriptors.data(), static_cast<uint32_t>(descriptors.size()),
+                            edf ? nullptr : priorities.data(), cores, heuristic, partition.data());
+}
+
+bool loadTaskSet(const std::string& path, TaskSet& tasks, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    tasks.clear();
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string field;
+        std::vector<uint64_t> values;
+        while (std::getline(fields, field, ',')) {
+            try {
+                values.push_back(std::stoull(field));
+            } catch (const std::exception&) {
+                error = path + ":" + std::to_string(lineNumber) + ": not a number: " + field;
+                return false;
+            }
+        }
+        if (values.size() < 4 || values.size() > 5 || values[1] == 0 || values[2] == 0) {
+            error = path + ":" + std::to_string(lineNumber) + ": expected id,period,deadline,wcet[,priority]";
+            return false;
+        }
+        Task task;
+        task.id = static_cast<uint32_t>(values[0]);
+        task.period = values[1];
+        task.deadline = values[2];
+        task.wcet = values[3];
+        task.priority = values.size() > 4 ? static_cast<uint32_t>(values[4]) : 0;
+        tasks.push_back(task);
+    }
+    return true;
+}
+
+bool parsePolicy(const std::string& name, PriorityPolicy& policy) {
+    if (name == "rm") {
+        policy = PRIORITY_RATE_MONOTONIC;
+    } else if (name == "dm") {
+        policy = PRIORITY_DEADLINE_MONOTONIC;
+    } else if (name == "explicit") {
+        policy = PRIORITY_EXPLICIT;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parseHeuristic(const std::string& name, PartitionHeuristic& heuristic) {
+    if (name == "ffd") {
+        heuristic = PARTITION_FIRST_FIT_DECREASING;
+    } else if (name == "wfd") {
+        heuristic = PARTITION_WORST_FIT_DECREASING;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+Task serverTask(const Server& server, const TaskSet& tasks) {
+    Task task;
+    task.id = APERIODIC_SERVER_TASK_ID;
+    task.period = server.period;
+    task.deadline = server.period;
+    task.wcet = server.budget;
+    for (const Task& other : tasks) {
+        task.priority = std::max(task.priority, other.priority + 1);
+    }
+    if (server.policy == APERIODIC_SERVER_DEFERRABLE) {
+        task.jitter = server.period - server.budget;
+    }
+    return task;
+}
+
+TaskSet systemTasks(const Task& server) {
+    Task console;
+    console.id = CONSOLE_TASK_ID;
+    console.period = TASK_MS(CONSOLE_POLL_MS);
+    console.deadline = console.period;
+    console.wcet = CONSOLE_POLL_WCET_US;
+    console.priority = server.priority + 1;
+    Task timers;
+    timers.id = TIMER_SERVICE_TASK_ID;
+    timers.period = TIMER_SERVICE_PERIOD_US;
+    timers.deadline = timers.period;
+    timers.wcet = TIMER_SERVICE_WCET_US;
+    timers.priority = server.priority + 2;
+    return {console, timers};
+}
+
+bool parseServerPolicy(const std::string& name, uint32_t& policy) {
+    if (name == "polling") {
+        policy = APERIODIC_SERVER_POLLING;
+    } else if (name == "deferrable") {
+        policy = APERIODIC_SERVER_DEFERRABLE;
+    } else if (name == "sporadic") {
+        policy = APERIODIC_SERVER_SPORADIC;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* serverPolicyName(uint32_t policy) {
+    switch (policy) {
+        case APERIODIC_SERVER_POLLING: return "polling";
+        case APERIODIC_SERVER_DEFERRABLE: return "deferrable";
+        default: return "sporadic";
+    }
+}
+
+ResourceSet firmwareResources() {
+    ResourceSet resources;
+    for (uint32_t r = 0; r < resourceSetSize; r++) {
+        Resource resource;
+        resource.id = resourceSet[r].id;
+        resource.hold = resourceSet[r].holdUs;
+        for (uint32_t user : resourceSet[r].users) {
+            if (user != 0) {
+                resource.users.push_back(user);
+            }
+        }
+        resources.push_back(resource);
+    }
+    return resources;
+}
+
+bool loadResources(const std::string& path, ResourceSet& resources, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    resources.clear();
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string field;
+        std::vector<uint64_t> values;
+        while (std::getline(fields, field, ',')) {
+            try {
+                values.push_back(std::stoull(field));
+            } catch (const std::exception&) {
+                error = path + ":" + std::to_string(lineNumber) + ": not a number: " + field;
+                return false;
+            }
+        }
+        if (values.size() < 3 || values.size() > 2 + RESOURCE_MAX_USERS) {
+            error = path + ":" + std::to_string(lineNumber) + ": expected id,hold,user[,user...] (at most " +
+                    std::to_string(RESOURCE_MAX_USERS) + " users)";
+            return false;
+        }
+        Resource resource;
+        resource.id = static_cast<uint32_t>(values[0]);
+        resource.hold = values[1];
+        for (size_t i = 2; i < values.size(); i++) {
+            resource.users.push_back(static_cast<uint32_t>(values[i]));
+        }
+        resources.push_back(resource);
+    }
+    return true;
+}
+
+std::vector<uint64_t> blockingTerms(const TaskSet& tasks, const ResourceSet& resources) {
+    std::vector<ResourceDescriptor> descriptors;
+    for (const Resource& resource : resources) {
+        ResourceDescriptor descriptor{};
+        descriptor.id = resource.id;
+        descriptor.holdUs = static_cast<uint32_t>(resource.hold);
+        for (size_t u = 0; u < resource.users.size() && u < RESOURCE_MAX_USERS; u++) {
+            descriptor.users[u] = resource.users[u];
+        }
+        descriptors.push_back(descriptor);
+    }
+    std::vector<uint32_t> ids;
+    std::vector<uint32_t> priorities;
+    for (const Task& task : tasks) {
+        ids.push_back(task.id);
+        priorities.push_back(task.priority);
+    }
+    std::vector<uint32_t> blocking(tasks.size());
+    resourceBlocking(descriptors.data(), static_cast<uint32_t>(descriptors.size()), ids.data(), priorities.data(),
+                     static_cast<uint32_t>(tasks.size()), blocking.data());
+    return std::vector<uint64_t>(blocking.begin(), blocking.end());
+}
+
+} // namespace sched
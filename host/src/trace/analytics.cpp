@@ -0,0 +1,230 @@
+#include "trace/analytics.hpp"
+
+#include <algorithm>
+
+namespace trace {
+
+namespace {
+
+// EventType values of the firmware (utils/traces/traces.h)
+constexpr uint32_t kJobStart = 1;
+constexpr uint32_t kJobCompletion = 0;
+constexpr uint32_t kEventsLost = 2;
+constexpr uint32_t kJobSkipped = 15;
+constexpr uint32_t kJobAborted = 16;
+constexpr uint32_t kModeChanged = 18;
+
+uint32_t clampUs(uint64_t us) {
+    return us > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(us);
+}
+
+} // namespace
+
+JobAnalyzer::JobAnalyzer(const std::vector<TaskBound>& bounds, uint64_t timestampScale, JobSink* jobs)
+    : bounds_(bounds), timestampScale_(timestampScale), jobs_(jobs) {}
+
+JobAnalyzer::TaskState& JobAnalyzer::task(uint32_t taskNum) {
+    auto found = tasks_.find(taskNum);
+    if (found != tasks_.end()) {
+        return found->second;
+    }
+    TaskState& state = tasks_[taskNum];
+    state.summary = summary_.tasks.size();
+    summary_.tasks.emplace_back();
+    TaskSummary& taskSummary = summary_.tasks.back();
+    taskSummary.taskNum = taskNum;
+    latencyHistogramInit(&taskSummary.response);
+    for (const TaskBound& bound : bounds_) {
+        if (bound.id == taskNum && bound.period > 0) {
+            state.bound = &bound;
+            taskSummary.known = true;
+        }
+    }
+    return state;
+}
+
+JobAnalyzer::CoreState& JobAnalyzer::core(uint32_t core) {
+    if (core >= cores_.size()) {
+        cores_.resize(core + 1);
+    }
+    return cores_[core];
+}
+
+void JobAnalyzer::onEvent(const Event& event) {
+    uint64_t timestamp = event.timestamp * timestampScale_;
+    if (!seenEvent_) {
+        seenEvent_ = true;
+        summary_.firstTimestamp = timestamp;
+    }
+    summary_.lastTimestamp = std::max(summary_.lastTimestamp, timestamp);
+
+    if (event.type == kJobStart) {
+        start(event, timestamp);
+    } else if (event.type == kJobCompletion || event.type == kJobAborted) {
+        complete(event, timestamp, event.type == kJobAborted);
+    } else if (event.type == kJobSkipped) {
+        skip(event);
+    } else if (event.type == kModeChanged) {
+        // the tasks of the new mode are released together at the timestamp
+        started_ = true;
+        phase_ = timestamp;
+        for (auto& entry : tasks_) {
+            entry.second.resync = true;
+        }
+        summary_.modeChanges++;
+    } else if (event.type == kEventsLost) {
+        summary_.lostEvents += event.taskNum;
+        // starts or completions of this core may be among them
+        for (auto& entry : tasks_) {
+            if (entry.second.job.core == event.core) {
+                entry.second.resync = true;
+            }
+        }
+    }
+}
+
+void JobAnalyzer::start(const Event& event, uint64_t timestamp) {
+    if (!started_) {
+        started_ = true;
+        phase_ = timestamp;
+    }
+    TaskState& state = task(event.taskNum);
+    if (state.active) {
+        // the completion of the previous job got lost: forget about that job
+        summary_.anomalies++;
+        remove(state, timestamp);
+    }
+
+    CoreState& coreState = core(event.core);
+    if (coreState.stack.empty()) {
+        coreState.busyStart = timestamp;
+    } else {
+        TaskState* running = coreState.stack.back();
+        summary_.tasks[running->summary].cpuTime += timestamp - coreState.sliceStart;
+        running->job.preemptions++;
+    }
+    coreState.stack.push_back(&state);
+    coreState.sliceStart = timestamp;
+
+    Job& job = state.job;
+    job.core = event.core;
+    job.taskNum = event.taskNum;
+    job.start = timestamp;
+    job.preemptions = 0;
+    if (state.bound == nullptr) {
+        job.index = state.nextIndex;
+        job.release = timestamp;
+    } else {
+        uint64_t period = state.bound->period;
+        if (state.resync || state.nextRelease > timestamp) {
+            // a job cannot start before its release: recount from the phase
+            state.nextIndex = timestamp >= phase_ ? (timestamp - phase_) / period : 0;
+            state.nextRelease = phase_ + state.nextIndex * period;
+            state.resync = false;
+        } else if (state.nextIndex == 0) {
+            state.nextRelease = phase_;
+        }
+        job.index = state.nextIndex;
+        job.release = state.nextRelease;
+        state.nextRelease += period;
+    }
+    state.nextIndex++;
+    state.active = true;
+}
+
+void JobAnalyzer::complete(const Event& event, uint64_t timestamp, bool aborted) {
+    auto found = tasks_.find(event.taskNum);
+    if (found == tasks_.end() || !found->second.active) {
+        summary_.anomalies++;
+        return;
+    }
+    TaskState& state = found->second;
+    CoreState& coreState = core(state.job.core);
+    if (coreState.stack.back() != &state) {
+        // the tasks above it should have completed first: end this job only
+        summary_.anomalies++;
+        remove(state, timestamp);
+        return;
+    }
+    remove(state, timestamp);
+
+    Job& job = state.job;
+    job.completion = timestamp;
+    job.aborted = aborted;
+    uint64_t response = job.completion - job.release;
+    job.met = !aborted && (state.bound == nullptr || response <= state.bound->deadline);
+    job.exceedsBound = !aborted && state.bound != nullptr && response > state.bound->wcrt;
+
+    TaskSummary& taskSummary = summary_.tasks[state.summary];
+    taskSummary.jobs++;
+    taskSummary.preemptions += job.preemptions;
+    if (aborted) {
+        taskSummary.aborted++;
+        summary_.aborted++;
+    } else {
+        taskSummary.maxResponse = std::max(taskSummary.maxResponse, response);
+        latencyHistogramRecord(&taskSummary.response, clampUs(response));
+    }
+    summary_.jobs++;
+    if (!job.met) {
+        taskSummary.missed++;
+        summary_.missed++;
+    }
+    if (job.exceedsBound) {
+        taskSummary.exceeded++;
+        summary_.exceeded++;
+    }
+    if (jobs_ != nullptr) {
+        jobs_->onJob(job);
+    }
+}
+
+void JobAnalyzer::skip(const Event& event) {
+    TaskState& state = task(event.taskNum);
+    // the dropped job has its release, it only never starts
+    if (state.bound != nullptr) {
+        state.nextRelease += state.bound->period;
+    }
+    state.nextIndex++;
+    summary_.tasks[state.summary].skipped++;
+    summary_.skipped++;
+}
+
+void JobAnalyzer::remove(TaskState& state, uint64_t timestamp) {
+    state.active = false;
+    CoreState& coreState = core(state.job.core);
+    auto position = std::find(coreState.stack.begin(), coreState.stack.end(), &state);
+    if (position == coreState.stack.end()) {
+        return;
+    }
+    bool running = position + 1 == coreState.stack.end();
+    coreState.stack.erase(position);
+    if (!running) {
+        return;
+    }
+    summary_.tasks[state.summary].cpuTime += timestamp - coreState.sliceStart;
+    coreState.sliceStart = timestamp;
+    if (coreState.stack.empty()) {
+        uint64_t length = timestamp - coreState.busyStart;
+        summary_.busyTime += length;
+        summary_.busyPeriods++;
+        summary_.longestBusyPeriod = std::max(summary_.longestBusyPeriod, length);
+    }
+}
+
+void JobAnalyzer::finish() {
+    for (CoreState& coreState : cores_) {
+        summary_.openJobs += coreState.stack.size();
+        if (!coreState.stack.empty()) {
+            // the jobs still running are accounted for up to the end of the trace
+            summary_.tasks[coreState.stack.back()->summary].cpuTime +=
+                summary_.lastTimestamp - coreState.sliceStart;
+            summary_.busyTime += summary_.lastTimestamp - coreState.busyStart;
+        }
+    }
+    summary_.cores = std::max<uint32_t>(static_cast<uint32_t>(cores_.size()), 1);
+    std::sort(summary_.tasks.begin(), summary_.tasks.end(),
+              [](const TaskSummary& a, const TaskSummary& b) { return a.taskNum < b.taskNum; });
+}
+
+} // namespace trace
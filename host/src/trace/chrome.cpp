@@ -0,0 +1,116 @@
+#include "trace/chrome.hpp"
+
+#include <charconv>
+#include <cstring>
+#include <string>
+
+namespace trace {
+
+namespace {
+
+constexpr size_t kBufferSize = size_t(1) << 16;
+// longest event line, metadata included
+constexpr size_t kMaxLine = 192;
+// per-core tracks are cached for task/core pairs up to this many cores
+constexpr uint32_t kMaxCores = 256;
+
+// string literals only: their length is known at compile time
+template <size_t N>
+char* put(char* p, const char (&text)[N]) {
+    std::memcpy(p, text, N - 1);
+    return p + N - 1;
+}
+
+char* put(char* p, uint64_t value) {
+    return std::to_chars(p, p + 20, value).ptr;
+}
+
+} // namespace
+
+ChromeJsonWriter::ChromeJsonWriter(std::FILE* out, bool perCore, uint64_t timestampScale)
+    : out_(out), perCore_(perCore), timestampScale_(timestampScale), buffer_(kBufferSize) {
+    append("[", 1);
+}
+
+ChromeJsonWriter::~ChromeJsonWriter() {
+    finish();
+}
+
+void ChromeJsonWriter::onSlice(const Slice& slice) {
+    if (buffer_.size() - used_ < 2 * kMaxLine) {
+        flush();
+    }
+    char* start = buffer_.data() + used_;
+    char* p = start;
+
+    if (perCore_ && (slice.core >= namedCores_.size() || !namedCores_[slice.core])) {
+        if (slice.core >= namedCores_.size()) {
+            namedCores_.resize(slice.core + 1);
+        }
+        namedCores_[slice.core] = true;
+        p = first_ ? put(p, "\n") : put(p, ",\n");
+        first_ = false;
+        p = put(p, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":");
+        p = put(p, slice.core);
+        p = put(p, ",\"args\":{\"name\":\"core ");
+        p = put(p, slice.core);
+        p = put(p, "\"}}");
+    }
+
+    p = first_ ? put(p, "\n") : put(p, ",\n");
+    first_ = false;
+    const Track& track = trackOf(slice);
+    std::memcpy(p, track.prefix.data(), track.prefix.size());
+    p += track.prefix.size();
+    *p++ = slice.phase;
+    std::memcpy(p, track.suffix.data(), track.suffix.size());
+    p += track.suffix.size();
+    p = put(p, slice.timestamp * timestampScale_);
+    *p++ = '}';
+    used_ += static_cast<size_t>(p - start);
+}
+
+const ChromeJsonWriter::Track& ChromeJsonWriter::trackOf(const Slice& slice) {
+    uint32_t key = perCore_ ? slice.taskNum * kMaxCores + slice.core : slice.taskNum;
+    if (key >= tracks_.size()) {
+        tracks_.resize(key + 1);
+    }
+    Track& track = tracks_[key];
+    if (track.prefix.empty()) {
+        std::string task = "task" + std::to_string(slice.taskNum);
+        track.prefix = "{\"name\":\"" + task + "\",\"cat\":\"task\",\"ph\":\"";
+        if (perCore_) {
+            track.suffix = "\",\"pid\":0,\"tid\":" + std::to_string(slice.core) + ",\"ts\":";
+        } else {
+            track.suffix = "\",\"pid\":" + std::to_string(slice.taskNum) + ",\"tid\":\"" + task + "\",\"ts\":";
+        }
+    }
+    return track;
+}
+
+void ChromeJsonWriter::finish() {
+    if (finished_) {
+        return;
+    }
+    finished_ = true;
+    append("\n]\n", 3);
+    flush();
+    std::fflush(out_);
+}
+
+void ChromeJsonWriter::append(const char* text, size_t length) {
+    if (buffer_.size() - used_ < length) {
+        flush();
+    }
+    std::memcpy(buffer_.data() + used_, text, length);
+    used_ += length;
+}
+
+void ChromeJsonWriter::flush() {
+    if (used_ > 0) {
+        std::fwrite(buffer_.data(), 1, used_, out_);
+        used_ = 0;
+    }
+}
+
+} // namespace trace
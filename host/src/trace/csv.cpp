@@ -0,0 +1,126 @@
+#include "trace/csv.hpp"
+
+#include <charconv>
+#include <cstring>
+
+namespace trace {
+
+namespace {
+
+constexpr size_t kBufferSize = size_t(1) << 16;
+// longest line: three 20-digit numbers, a 10-digit one, separators and newline
+constexpr size_t kMaxLine = 96;
+
+} // namespace
+
+CsvWriter::CsvWriter(std::FILE* out, bool withCore)
+    : out_(out), withCore_(withCore), buffer_(kBufferSize) {}
+
+CsvWriter::~CsvWriter() {
+    flush();
+}
+
+void CsvWriter::onEvent(const Event& event) {
+    if (buffer_.size() - used_ < kMaxLine) {
+        flush();
+    }
+    char* p = buffer_.data() + used_;
+    char* end = buffer_.data() + buffer_.size();
+    p = std::to_chars(p, end, event.taskNum).ptr;
+    *p++ = ',';
+    p = std::to_chars(p, end, event.type).ptr;
+    *p++ = ',';
+    p = std::to_chars(p, end, event.timestamp).ptr;
+    if (withCore_) {
+        *p++ = ',';
+        p = std::to_chars(p, end, event.core).ptr;
+    }
+    *p++ = '\n';
+    used_ = static_cast<size_t>(p - buffer_.data());
+}
+
+void CsvWriter::finish() {
+    flush();
+    std::fflush(out_);
+}
+
+void CsvWriter::flush() {
+    if (used_ > 0) {
+        std::fwrite(buffer_.data(), 1, used_, out_);
+        used_ = 0;
+    }
+}
+
+CsvReader::CsvReader(EventSink& sink) : sink_(sink) {}
+
+void CsvReader::feed(const char* data, size_t length) {
+    const char* end = data + length;
+    const char* line = data;
+    if (!carry_.empty()) {
+        // complete the line that straddles the chunk boundary
+        const char* newline = static_cast<const char*>(std::memchr(data, '\n', length));
+        if (newline == nullptr) {
+            carry_.insert(carry_.end(), data, end);
+            return;
+        }
+        carry_.insert(carry_.end(), data, newline);
+        parseLine(carry_.data(), carry_.data() + carry_.size());
+        carry_.clear();
+        line = newline + 1;
+    }
+    for (;;) {
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', static_cast<size_t>(end - line)));
+        if (newline == nullptr) {
+            carry_.assign(line, end);
+            return;
+        }
+        parseLine(line, newline);
+        line = newline + 1;
+    }
+}
+
+void CsvReader::finish() {
+    if (!carry_.empty()) {
+        parseLine(carry_.data(), carry_.data() + carry_.size());
+        carry_.clear();
+    }
+    sink_.finish();
+}
+
+void CsvReader::parseLine(const char* begin, const char* end) {
+    if (end > begin && end[-1] == '\r') {
+        end--;
+    }
+    if (begin == end) {
+        return;
+    }
+    lines_++;
+    uint64_t fields[4] = {0, 0, 0, 0};
+    int count = 0;
+    const char* p = begin;
+    while (count < 4) {
+        auto result = std::from_chars(p, end, fields[count]);
+        if (result.ec != std::errc()) {
+            skippedLines_++;
+            return;
+        }
+        count++;
+        p = result.ptr;
+        if (p == end) {
+            break;
+        }
+        if (*p != ',') {
+            skippedLines_++;
+            return;
+        }
+        p++;
+    }
+    if (count < 3 || p != end) {
+        skippedLines_++;
+        return;
+    }
+    sink_.onEvent(Event{static_cast<uint32_t>(fields[3]), static_cast<uint32_t>(fields[0]),
+                        static_cast<uint32_t>(fields[1]), fields[2]});
+}
+
+} // namespace trace
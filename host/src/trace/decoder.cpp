@@ -0,0 +1,169 @@
+#include "trace/decoder.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "utils/traces/traceFormat.h"
+
+namespace trace {
+
+namespace {
+
+// offset of the body in a frame: sync bytes + header
+constexpr size_t kBodyOffset = 2 + TRACE_FRAME_HEADER_SIZE;
+
+uint16_t readLe16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+} // namespace
+
+FrameDecoder::FrameDecoder(EventSink& sink) : sink_(sink) {
+    lastSeq_.fill(-1);
+}
+
+void FrameDecoder::feed(const uint8_t* data, size_t length) {
+    stats_.bytes += length;
+    if (carry_.empty()) {
+        size_t used = parse(data, length);
+        carry_.assign(data + used, data + length);
+        return;
+    }
+    // a frame straddles the chunk boundary: complete it from the new chunk
+    carry_.insert(carry_.end(), data, data + length);
+    size_t used = parse(carry_.data(), carry_.size());
+    carry_.erase(carry_.begin(), carry_.begin() + static_cast<std::ptrdiff_t>(used));
+}
+
+void FrameDecoder::finish() {
+    stats_.skippedBytes += carry_.size();
+    carry_.clear();
+    sink_.finish();
+}
+
+size_t FrameDecoder::parse(const uint8_t* data, size_t length) {
+    size_t pos = 0;
+    while (pos < length) {
+        const uint8_t* sync = static_cast<const uint8_t*>(memchr(data + pos, TRACE_FRAME_SYNC0, length - pos));
+        if (sync == nullptr) {
+            stats_.skippedBytes += length - pos;
+            return length;
+        }
+        size_t start = static_cast<size_t>(sync - data);
+        stats_.skippedBytes += start - pos;
+        pos = start;
+
+        if (length - pos < kBodyOffset) {
+            return pos; // need more bytes to see the header
+        }
+        const uint8_t* frame = data + pos;
+        size_t bodyLength = readLe16(frame + 6);
+        if (frame[1] != TRACE_FRAME_SYNC1 || frame[2] == 0 || frame[2] > TRACE_FORMAT_VERSION ||
+            bodyLength > TRACE_FRAME_MAX_BODY) {
+            // not a frame header, resynchronise on the next byte
+            stats_.skippedBytes++;
+            pos++;
+            continue;
+        }
+        size_t frameLength = kBodyOffset + bodyLength + 2;
+        if (length - pos < frameLength) {
+            return pos;
+        }
+        uint16_t crc = traceCrc16(0xFFFF, frame + 2, static_cast<uint32_t>(TRACE_FRAME_HEADER_SIZE + bodyLength));
+        if (crc != readLe16(frame + kBodyOffset + bodyLength)) {
+            stats_.crcErrors++;
+            stats_.skippedBytes++;
+            pos++;
+            continue;
+        }
+
+        uint32_t core = frame[3];
+        int32_t seq = readLe16(frame + 4);
+        if (lastSeq_[core] >= 0) {
+            uint16_t gap = static_cast<uint16_t>(seq - lastSeq_[core] - 1);
+            // a jump backwards is a restart of the firmware, not a loss
+            if (gap < 0x8000) {
+                stats_.lostFrames += gap;
+            }
+        }
+        lastSeq_[core] = seq;
+        stats_.frames++;
+        if (!decodeBody(core, frame + kBodyOffset, bodyLength)) {
+            stats_.badFrames++;
+        }
+        pos += frameLength;
+    }
+    return pos;
+}
+
+bool FrameDecoder::decodeBody(uint32_t core, const uint8_t* body, size_t length) {
+    uint64_t timestamp;
+    uint32_t used = traceVarintGet(body, static_cast<uint32_t>(length), &timestamp);
+    if (used == 0) {
+        return false;
+    }
+    // a CRC-valid frame with a broken body is dropped as a whole
+    frameEvents_.clear();
+    size_t pos = used;
+    while (pos < length) {
+        TraceRecord record;
+        used = traceDecodeRecord(body + pos, static_cast<uint32_t>(length - pos), &record);
+        if (used == 0) {
+            return false;
+        }
+        timestamp += static_cast<uint64_t>(record.timestampDelta);
+        if (record.event == TRACE_EVENT_LOST) {
+            stats_.lossRecords++;
+            stats_.lostEvents += record.taskNum;
+        }
+        frameEvents_.push_back(Event{core, record.taskNum, record.event, timestamp});
+        pos += used;
+    }
+    for (const Event& event : frameEvents_) {
+        sink_.onEvent(event);
+    }
+    stats_.records += frameEvents_.size();
+    return true;
+}
+
+CoreMerger::CoreMerger(EventSink& sink, uint32_t cores, size_t maxBuffered)
+    : sink_(sink), maxBuffered_(maxBuffered), queues_(cores) {}
+
+void CoreMerger::onEvent(const Event& event) {
+    if (event.core >= queues_.size()) {
+        queues_.resize(event.core + 1);
+    }
+    queues_[event.core].push_back(event);
+    buffered_++;
+
+    // the oldest event can go as soon as no core can come up with an older one
+    for (;;) {
+        bool allPending = std::all_of(queues_.begin(), queues_.end(),
+                                      [](const std::deque<Event>& queue) { return !queue.empty(); });
+        if (!allPending && buffered_ <= maxBuffered_) {
+            break;
+        }
+        emitOldest();
+    }
+}
+
+void CoreMerger::finish() {
+    while (buffered_ > 0) {
+        emitOldest();
+    }
+    sink_.finish();
+}
+
+void CoreMerger::emitOldest() {
+    std::deque<Event>* oldest = nullptr;
+    for (std::deque<Event>& queue : queues_) {
+        if (!queue.empty() && (oldest == nullptr || queue.front().timestamp < oldest->front().timestamp)) {
+            oldest = &queue;
+        }
+    }
+    sink_.onEvent(oldest->front());
+    oldest->pop_front();
+    buffered_--;
+}
+
+} // namespace trace
@@ -0,0 +1,144 @@
+#include "trace/input.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "trace/csv.hpp"
+
+namespace trace {
+
+namespace {
+
+constexpr size_t kChunkSize = size_t(1) << 20;
+// how much of the input is looked at to tell binary from text
+constexpr size_t kSniffSize = 4096;
+
+InputFormat sniff(const uint8_t* data, size_t length) {
+    size_t n = length < kSniffSize ? length : kSniffSize;
+    for (size_t i = 0; i < n; i++) {
+        uint8_t c = data[i];
+        // frames start with a byte above ASCII and are full of control characters
+        if (c >= 0x80 || (c < 0x20 && c != '\n' && c != '\r' && c != '\t')) {
+            return InputFormat::Binary;
+        }
+    }
+    return InputFormat::Csv;
+}
+
+// feeds either parser, whichever the input turns out to be
+class Parser {
+public:
+    Parser(EventSink& sink, uint32_t cores)
+        : merger_(sink, cores), decoder_(merger_), csv_(sink) {}
+
+    void feed(const uint8_t* data, size_t length, InputStats& stats) {
+        if (stats.format == InputFormat::Auto) {
+            stats.format = sniff(data, length);
+        }
+        stats.bytes += length;
+        if (stats.format == InputFormat::Binary) {
+            decoder_.feed(data, length);
+        } else {
+            csv_.feed(reinterpret_cast<const char*>(data), length);
+        }
+    }
+
+    void finish(InputStats& stats) {
+        if (stats.format == InputFormat::Binary) {
+            decoder_.finish();
+            stats.decoder = decoder_.stats();
+        } else {
+            stats.format = InputFormat::Csv;
+            csv_.finish();
+            stats.lines = csv_.lines();
+            stats.skippedLines = csv_.skippedLines();
+        }
+    }
+
+private:
+    CoreMerger merger_;
+    FrameDecoder decoder_;
+    CsvReader csv_;
+};
+
+} // namespace
+
+bool readTrace(const std::string& path, InputFormat format, EventSink& sink, InputStats& stats,
+               uint32_t cores) {
+    stats = InputStats();
+    stats.format = format;
+    Parser parser(sink, cores);
+
+    int fd = path == "-" ? STDIN_FILENO : open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::perror(path.c_str());
+        return false;
+    }
+    struct stat info;
+    if (fd != STDIN_FILENO && fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        size_t length = static_cast<size_t>(info.st_size);
+        void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            madvise(mapped, length, MADV_SEQUENTIAL);
+            const uint8_t* data = static_cast<const uint8_t*>(mapped);
+            // hand the mapping over in chunks so that consumed pages can be dropped
+            for (size_t offset = 0; offset < length; offset += kChunkSize) {
+                size_t n = length - offset < kChunkSize ? length - offset : kChunkSize;
+                parser.feed(data + offset, n, stats);
+                if (offset > 0) {
+                    madvise(const_cast<uint8_t*>(data) + offset - kChunkSize, kChunkSize, MADV_DONTNEED);
+                }
+            }
+            parser.finish(stats);
+            munmap(mapped, length);
+            close(fd);
+            return true;
+        }
+    }
+
+    std::vector<uint8_t> chunk(kChunkSize);
+    for (;;) {
+        ssize_t n = read(fd, chunk.data(), chunk.size());
+        if (n < 0) {
+            std::perror(path.c_str());
+            if (fd != STDIN_FILENO) {
+                close(fd);
+            }
+            return false;
+        }
+        if (n == 0) {
+            break;
+        }
+        parser.feed(chunk.data(), static_cast<size_t>(n), stats);
+    }
+    parser.finish(stats);
+    if (fd != STDIN_FILENO) {
+        close(fd);
+    }
+    return true;
+}
+
+void printInputStats(const char* label, const InputStats& stats) {
+    if (stats.format == InputFormat::Binary) {
+        const DecoderStats& d = stats.decoder;
+        std::fprintf(stderr,
+                     "%s: binary, %llu bytes, %llu frames, %llu events, %llu lost frames, "
+                     "%llu CRC errors, %llu bad frames, %llu bytes skipped\n",
+                     label, (unsigned long long)stats.bytes, (unsigned long long)d.frames,
+                     (unsigned long long)d.records, (unsigned long long)d.lostFrames,
+                     (unsigned long long)d.crcErrors, (unsigned long long)d.badFrames,
+                     (unsigned long long)d.skippedBytes);
+    } else {
+        std::fprintf(stderr, "%s: CSV, %llu bytes, %llu lines, %llu lines skipped\n", label,
+                     (unsigned long long)stats.bytes, (unsigned long long)stats.lines,
+                     (unsigned long long)stats.skippedLines);
+    }
+}
+
+} // namespace trace
@@ -0,0 +1,179 @@
+#include "trace/preemption.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+namespace trace {
+
+namespace {
+
+// EventType values of the firmware (utils/traces/traces.h)
+constexpr uint32_t kJobStart = 1;
+constexpr uint32_t kJobCompletion = 0;
+constexpr uint32_t kEventsLost = 2;
+constexpr uint32_t kTaskSwitchedIn = 8;
+constexpr uint32_t kTaskSwitchedOut = 9;
+// the end of a job stopped by the deadline watchdog, a completion here
+constexpr uint32_t kJobAborted = 16;
+
+// only the first anomalies are printed, the rest are only counted
+constexpr uint64_t kMaxReported = 10;
+
+} // namespace
+
+PreemptionBuilder::PreemptionBuilder(SliceSink& sink, bool perCore, bool verbose)
+    : sink_(sink), perCore_(perCore), verbose_(verbose) {}
+
+void PreemptionBuilder::onEvent(const Event& event) {
+    stats_.events++;
+    if (event.type == kEventsLost) {
+        onLoss(event);
+        return;
+    }
+    if (event.core >= eventNumbers_.size()) {
+        eventNumbers_.resize(event.core + 1);
+    }
+    eventNumbers_[event.core]++;
+    if (event.type == kTaskSwitchedIn || event.type == kTaskSwitchedOut) {
+        onSwitch(event);
+        return;
+    }
+    uint32_t core = perCore_ ? event.core : 0;
+    if (core >= cores_.size()) {
+        cores_.resize(core + 1);
+    }
+    CoreState& state = cores_[core];
+    if (state.kernel || (event.type != kJobStart && event.type != kJobCompletion && event.type != kJobAborted)) {
+        // other kernel events, or job events of a core already covered by the switches
+        return;
+    }
+    std::vector<uint32_t>& stack = state.stack;
+    uint64_t ts = event.timestamp;
+
+    if (event.type == kJobStart) {
+        auto active = std::find(stack.begin(), stack.end(), event.taskNum);
+        if (active != stack.end()) {
+            // the completion of the previous job got lost: forget about that job
+            report("start of an already active task", event);
+            stats_.startWhileActive++;
+            bool running = active + 1 == stack.end();
+            stack.erase(active);
+            if (running) {
+                emit(state, Slice{core, event.taskNum, 'E', ts});
+            }
+        }
+        if (!stack.empty()) {
+            emit(state, Slice{core, stack.back(), 'E', ts});
+            stats_.preemptions++;
+        }
+        stack.push_back(event.taskNum);
+        emit(state, Slice{core, event.taskNum, 'B', ts});
+        return;
+    }
+
+    if (stack.empty() || stack.back() != event.taskNum) {
+        auto active = std::find(stack.begin(), stack.end(), event.taskNum);
+        if (active == stack.end()) {
+            report("completion of a task that is not active", event);
+            stats_.endWithoutStart++;
+        } else {
+            // the tasks above it should have completed first: end this job only
+            report("completion of a preempted task", event);
+            stats_.endNotRunning++;
+            stack.erase(active);
+        }
+        return;
+    }
+    emit(state, Slice{core, event.taskNum, 'E', ts});
+    stack.pop_back();
+    if (!stack.empty()) {
+        emit(state, Slice{core, stack.back(), 'B', ts});
+    }
+}
+
+void PreemptionBuilder::onSwitch(const Event& event) {
+    // a core only runs one task at a time, the switches of each core are exact
+    // on their own even when the job events are treated as one processor
+    uint32_t core = event.core;
+    if (core >= cores_.size()) {
+        cores_.resize(core + 1);
+    }
+    CoreState& state = cores_[core];
+    std::vector<uint32_t>& stack = state.stack;
+    if (!state.kernel) {
+        // close whatever the job events opened so far
+        state.kernel = true;
+        if (!stack.empty()) {
+            emit(state, Slice{core, stack.back(), 'E', event.timestamp});
+            stack.clear();
+        }
+    }
+    if (!stack.empty()) {
+        // a missed switch-out, or the switch-out we are handling
+        emit(state, Slice{core, stack.back(), 'E', event.timestamp});
+        stack.clear();
+    }
+    if (event.type == kTaskSwitchedIn) {
+        stats_.switches++;
+        stack.push_back(event.taskNum);
+        emit(state, Slice{core, event.taskNum, 'B', event.timestamp});
+    }
+}
+
+void PreemptionBuilder::onLoss(const Event& event) {
+    // the job events around the gap are repaired like any other inconsistency
+    if (event.core >= eventNumbers_.size()) {
+        eventNumbers_.resize(event.core + 1);
+    }
+    uint64_t first = eventNumbers_[event.core];
+    eventNumbers_[event.core] += event.taskNum;
+    if (verbose_ && stats_.lossRecords < kMaxReported) {
+        std::fprintf(stderr, "warning: %" PRIu32 " events lost on core %" PRIu32 " (events %" PRIu64 "..%" PRIu64
+                     ") from %" PRIu64 "\n",
+                     event.taskNum, event.core, first, first + event.taskNum - 1, event.timestamp);
+    }
+    stats_.lossRecords++;
+    stats_.lostEvents += event.taskNum;
+}
+
+void PreemptionBuilder::finish() {
+    for (CoreState& state : cores_) {
+        // a trailing begin is dropped so that the trace does not end on an empty task
+        state.held = false;
+        stats_.openAtEnd += state.stack.size();
+    }
+    sink_.finish();
+}
+
+void PreemptionBuilder::emit(CoreState& state, const Slice& slice) {
+    if (slice.phase == 'B') {
+        if (state.held) {
+            sink_.onSlice(state.heldBegin);
+            stats_.slices++;
+        }
+        state.heldBegin = slice;
+        state.held = true;
+        return;
+    }
+    if (state.held) {
+        state.held = false;
+        if (state.heldBegin.taskNum == slice.taskNum && state.heldBegin.timestamp == slice.timestamp) {
+            stats_.zeroLength++;
+            return;
+        }
+        sink_.onSlice(state.heldBegin);
+        stats_.slices++;
+    }
+    sink_.onSlice(slice);
+    stats_.slices++;
+}
+
+void PreemptionBuilder::report(const char* what, const Event& event) {
+    if (verbose_ && stats_.anomalies() < kMaxReported) {
+        std::fprintf(stderr, "warning: %s: task %" PRIu32 " on core %" PRIu32 " at %" PRIu64 "\n",
+                     what, event.taskNum, event.core, event.timestamp);
+    }
+}
+
+} // namespace trace
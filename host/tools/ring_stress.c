@@ -0,0 +1,149 @@
+// Stress run of the per-core trace rings: one producer thread per core pushes
+// numbered events as fast as it can while a consumer thread drains all rings
+// concurrently, the way vLoggingTask does on target. Every event must either be
+// received in order or be accounted for by a loss record standing exactly in its
+// place (the timestamps are the event numbers), and the loss records must add up
+// to the ring's drop counter.
+//
+// usage: ring_stress [events per producer] [lossless]
+//
+// With `lossless` the producers wait for free space instead of dropping, which
+// exercises the wrap-around of every slot many times over.
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "utils/traces/traceRing.h"
+#include "utils/traces/tracePort.h"
+
+static TraceRing rings[TRACE_NUM_CORES];
+static uint32_t eventsPerProducer = 10000000;
+static int lossless = 0;
+static atomic_uint producersDone;
+
+static void *producer(void *arg) {
+    uint32_t core = (uint32_t)(uintptr_t)arg;
+    tracePortSetCoreId(core);
+    for (uint32_t i = 0; i < eventsPerProducer; i++) {
+        while (lossless && TRACE_RING_SIZE - traceRingPending(&rings[core]) < TRACE_RECORD_MAX_SIZE) {
+            sched_yield();
+        }
+        TracePortState state = tracePortEnterLocal();
+        traceRingPush(&rings[tracePortCoreId()], core, i & 1, i);
+        tracePortExitLocal(state);
+    }
+    atomic_fetch_add(&producersDone, 1);
+    return NULL;
+}
+
+typedef struct {
+    uint64_t received[TRACE_NUM_CORES];
+    // events accounted for by loss records
+    uint64_t lost[TRACE_NUM_CORES];
+    uint64_t lossRecords;
+    uint64_t errors;
+} ConsumerResult;
+
+static void *consumer(void *arg) {
+    ConsumerResult *result = arg;
+    int64_t last[TRACE_NUM_CORES];
+    uint64_t timestamp[TRACE_NUM_CORES];
+    for (uint32_t core = 0; core < TRACE_NUM_CORES; core++) {
+        last[core] = -1;
+        timestamp[core] = 0;
+    }
+    for (;;) {
+        // read the flag first so that a final pass sees everything pushed before it
+        int finished = atomic_load(&producersDone) == TRACE_NUM_CORES;
+        for (uint32_t core = 0; core < TRACE_NUM_CORES; core++) {
+            uint32_t pending = traceRingPending(&rings[core]);
+            uint32_t offset = 0;
+            while (offset < pending) {
+                uint8_t encoded[TRACE_RECORD_MAX_SIZE];
+                TraceRecord record;
+                uint32_t length = traceRingPeek(&rings[core], offset, pending, encoded, &record);
+                if (length == 0) {
+                    result->errors++;
+                    offset = pending;
+                    break;
+                }
+                timestamp[core] += record.timestampDelta;
+                offset += length;
+                // event numbers continue without a gap across a loss record
+                if ((int64_t)timestamp[core] != last[core] + 1) {
+                    result->errors++;
+                }
+                if (record.event == TRACE_EVENT_LOST) {
+                    result->lost[core] += record.taskNum;
+                    result->lossRecords++;
+                    last[core] = (int64_t)(timestamp[core] + record.taskNum - 1);
+                    continue;
+                }
+                if (record.taskNum != core) {
+                    result->errors++;
+                }
+                last[core] = (int64_t)timestamp[core];
+                result->received[core]++;
+            }
+            traceRingRelease(&rings[core], offset);
+        }
+        if (finished) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        eventsPerProducer = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+    lossless = argc > 2;
+    for (uint32_t core = 0; core < TRACE_NUM_CORES; core++) {
+        traceRingInit(&rings[core]);
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    ConsumerResult result = {0};
+    pthread_t consumerThread;
+    pthread_t producerThreads[TRACE_NUM_CORES];
+    pthread_create(&consumerThread, NULL, consumer, &result);
+    for (uint32_t core = 0; core < TRACE_NUM_CORES; core++) {
+        pthread_create(&producerThreads[core], NULL, producer, (void *)(uintptr_t)core);
+    }
+    for (uint32_t core = 0; core < TRACE_NUM_CORES; core++) {
+        pthread_join(producerThreads[core], NULL);
+    }
+    pthread_join(consumerThread, NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    int ok = result.errors == 0;
+    uint64_t received = 0;
+    for (uint32_t core = 0; core < TRACE_NUM_CORES; core++) {
+        uint32_t dropped = atomic_load(&rings[core].dropped);
+        // the drops after the last stored record have no loss record yet
+        uint32_t unreported = rings[core].unreported;
+        printf("core %" PRIu32 ": received %" PRIu64 ", dropped %" PRIu32 " (%" PRIu64 " in loss records, %" PRIu32
+               " at the end)\n",
+               core, result.received[core], dropped, result.lost[core], unreported);
+        if (result.received[core] + dropped != eventsPerProducer || result.lost[core] + unreported != dropped) {
+            ok = 0;
+        }
+        received += result.received[core];
+    }
+    printf("out-of-order, misplaced or corrupted records: %" PRIu64 ", loss records: %" PRIu64 "\n", result.errors,
+           result.lossRecords);
+    printf("%.1f M events/s pushed, %.1f M events/s drained\n",
+           TRACE_NUM_CORES * (double)eventsPerProducer / seconds / 1e6, (double)received / seconds / 1e6);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
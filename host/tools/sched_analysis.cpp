@@ -0,0 +1,331 @@
+// Schedulability analysis of a periodic task set: utilization, hyperperiod,
+// exact fixed-priority response-time analysis (worst-case response time of
+// every task) and the exact EDF processor-demand test.
+//
+// usage: sched_analysis [--tasks tasks.csv | --mode N] [--policy rm|dm|explicit] [--cores N]
+//                       [--heuristic ffd|wfd] [--resources resources.csv | --no-resources]
+//                       [--server polling|deferrable|sporadic [--server-budget US] [--server-period US]]
+//        sched_analysis --random N [--n TASKS] [--utilization U] [--deadline-ratio R] [--seed S]
+//                       [--cores N] [--heuristic ffd|wfd]
+//
+// Without --tasks the task table compiled into the firmware (taskTable.c) is
+// analysed, or with --mode the task set of that operating mode (modeTable.c);
+// the firmware switches modes once every job of the old mode has completed, so
+// the longest response time of the mode also bounds the latency of a mode
+// change out of it, which is reported with it. --random evaluates N random task sets (UUniFast) under RM, DM and
+// EDF, reports the fraction found schedulable and the analysis throughput.
+// With --cores the tasks are first partitioned with the firmware's assigner
+// (taskSetPartition, PERIODIC_PLACEMENT_PARTITIONED) and every core is analysed
+// on its own; --utilization is then the total over all cores.
+//
+// --server adds the firmware's aperiodic server (aperiodicServer.h) above every
+// task, with the budget and period configured there unless given, on core
+// APERIODIC_SERVER_CORE; the largest budget the task set can afford is
+// reported as well.
+//
+// The fixed-priority analysis includes the blocking on shared resources under
+// the immediate priority ceiling protocol (resource.h): one critical section per
+// job at most, the longest of a lower task on a resource whose ceiling reaches
+// the task's priority, among the tasks of its core. The resources are those of
+// the firmware (resourceTable.c) with the firmware's task table, none with
+// --tasks unless --resources gives them (`id,hold,user[,user...]` lines). The
+// EDF test leaves the blocking out.
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "sched/analysis.hpp"
+#include "sched/generator.hpp"
+#include "sched/task.hpp"
+
+static int usage(const char* program) {
+    std::fprintf(stderr,
+                 "usage: %s [--tasks tasks.csv | --mode N] [--policy rm|dm|explicit] [--cores N]\n"
+                 "          [--heuristic ffd|wfd] [--resources resources.csv | --no-resources]\n"
+                 "          [--server polling|deferrable|sporadic [--server-budget US] [--server-period US]]\n"
+                 "       %s --random N [--n TASKS] [--utilization U] [--deadline-ratio R] [--seed S]\n"
+                 "          [--cores N] [--heuristic ffd|wfd]\n",
+                 program, program);
+    return 2;
+}
+
+static const char* policyName(PriorityPolicy policy) {
+    switch (policy) {
+        case PRIORITY_RATE_MONOTONIC: return "rate monotonic";
+        case PRIORITY_DEADLINE_MONOTONIC: return "deadline monotonic";
+        default: return "explicit";
+    }
+}
+
+static const char* heuristicName(PartitionHeuristic heuristic) {
+    return heuristic == PARTITION_WORST_FIT_DECREASING ? "worst fit decreasing" : "first fit decreasing";
+}
+
+// the tasks of `tasks` on `core`, `members` receives their indices in `tasks`
+static sched::TaskSet tasksOnCore(const sched::TaskSet& tasks, const std::vector<uint32_t>& partition,
+                                  uint32_t core, std::vector<size_t>& members) {
+    sched::TaskSet onCore;
+    members.clear();
+    for (size_t i = 0; i < tasks.size(); i++) {
+        if (partition[i] == core) {
+            onCore.push_back(tasks[i]);
+            members.push_back(i);
+        }
+    }
+    return onCore;
+}
+
+static int analyse(const sched::TaskSet& periodic, const sched::ResourceSet& resources, PriorityPolicy policy,
+                   uint32_t cores, PartitionHeuristic heuristic, const sched::Server* server, const TaskMode* mode) {
+    // on one core every task is on core 0
+    std::vector<uint32_t> fixedPartition(periodic.size(), 0);
+    std::vector<uint32_t> edfPartition(periodic.size(), 0);
+    if (cores > 1) {
+        sched::partitionTasks(periodic, cores, heuristic, false, fixedPartition);
+        sched::partitionTasks(periodic, cores, heuristic, true, edfPartition);
+    }
+    // the server goes to its core after the periodic tasks, like on target
+    sched::TaskSet tasks = periodic;
+    if (server != nullptr) {
+        tasks.push_back(sched::serverTask(*server, periodic));
+        // with the console and timer service tasks above it, on its core
+        for (const sched::Task& task : sched::systemTasks(tasks.back())) {
+            tasks.push_back(task);
+        }
+        fixedPartition.resize(tasks.size(), cores > 1 ? APERIODIC_SERVER_CORE : 0);
+        edfPartition.resize(tasks.size(), cores > 1 ? APERIODIC_SERVER_CORE : 0);
+    }
+    std::vector<uint64_t> responseTimes(tasks.size());
+    std::vector<uint64_t> blocking(tasks.size());
+    bool fixedPriority = true;
+    bool edf = true;
+    std::vector<size_t> members;
+    for (uint32_t core = 0; core < cores; core++) {
+        sched::TaskSet onCore = tasksOnCore(tasks, fixedPartition, core, members);
+        std::vector<uint64_t> coreResponseTimes(onCore.size());
+        std::vector<uint64_t> coreBlocking = sched::blockingTerms(onCore, resources);
+        fixedPriority &= sched::responseTimeAnalysis(onCore.data(), onCore.size(), coreResponseTimes.data(),
+                                                     coreBlocking.data());
+        for (size_t k = 0; k < members.size(); k++) {
+            responseTimes[members[k]] = coreResponseTimes[k];
+            blocking[members[k]] = coreBlocking[k];
+        }
+        edf &= sched::edfSchedulable(tasksOnCore(tasks, edfPartition, core, members));
+    }
+    uint64_t hyper = sched::hyperperiod(tasks);
+
+    if (mode != nullptr) {
+        std::printf("mode %s\n", mode->name);
+    }
+    std::printf("%zu tasks, utilization %.4f, hyperperiod ", tasks.size(), sched::utilization(tasks));
+    if (hyper == sched::kUnbounded) {
+        std::printf("overflows 64 bits\n");
+    } else {
+        std::printf("%" PRIu64 " us\n\n", hyper);
+    }
+    if (cores > 1) {
+        std::printf("fixed priority (%s, %" PRIu32 " cores, %s):\n", policyName(policy), cores,
+                    heuristicName(heuristic));
+    } else {
+        std::printf("fixed priority (%s):\n", policyName(policy));
+    }
+    std::printf("%6s %10s %10s %10s %5s %5s %8s %10s %8s\n", "task", "period", "deadline", "wcet", "prio", "core",
+                "block", "wcrt", "verdict");
+    for (size_t i = 0; i < tasks.size(); i++) {
+        const sched::Task& task = tasks[i];
+        char wcrt[24];
+        if (responseTimes[i] == sched::kUnbounded) {
+            std::snprintf(wcrt, sizeof(wcrt), "unbounded");
+        } else {
+            std::snprintf(wcrt, sizeof(wcrt), "%" PRIu64, responseTimes[i]);
+        }
+        std::printf("%6" PRIu32 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %5" PRIu32 " %5" PRIu32 " %8" PRIu64
+                    " %10s %8s\n",
+                    task.id, task.period, task.deadline, task.wcet, task.priority, fixedPartition[i], blocking[i],
+                    wcrt, responseTimes[i] <= task.deadline ? "ok" : "MISS");
+    }
+    std::printf("\nfixed priority: %s\n", fixedPriority ? "schedulable" : "NOT schedulable");
+    if (mode != nullptr && taskModeCount > 1) {
+        // the jobs in progress at the request run to completion, the server keeps running
+        uint64_t latency = 0;
+        for (size_t i = 0; i < periodic.size(); i++) {
+            latency = std::max(latency, responseTimes[i]);
+        }
+        if (latency == sched::kUnbounded) {
+            std::printf("mode change out of %s: unbounded\n", mode->name);
+        } else {
+            std::printf("mode change out of %s: at most %" PRIu64 " us\n", mode->name, latency);
+        }
+    }
+    if (server != nullptr) {
+        // the periodic tasks sharing the server's core decide how big it may get
+        std::vector<size_t> members;
+        sched::TaskSet serverCore = tasksOnCore(periodic, fixedPartition, fixedPartition.back(), members);
+        std::vector<uint64_t> serverCoreBlocking = sched::blockingTerms(serverCore, resources);
+        uint64_t budget = sched::maxServerBudget(serverCore, *server, serverCoreBlocking.data());
+        std::printf("%s server: %" PRIu64 " us every %" PRIu64 " us", sched::serverPolicyName(server->policy),
+                    server->budget, server->period);
+        if (budget == sched::kUnbounded) {
+            std::printf(", no budget fits\n");
+        } else {
+            std::printf(", at most %" PRIu64 " us (%.1f%%) fits\n", budget, 100.0 * budget / server->period);
+        }
+        // it runs above the EDF tasks, which the demand test does not model
+        std::printf("EDF:            not analysed with an aperiodic server\n");
+        return fixedPriority ? 0 : 1;
+    }
+    std::printf("EDF:            %s", edf ? "schedulable" : "NOT schedulable");
+    if (cores > 1) {
+        std::printf(" (cores");
+        for (size_t i = 0; i < tasks.size(); i++) {
+            std::printf("%s%" PRIu32, i == 0 ? " " : ",", edfPartition[i]);
+        }
+        std::printf(")");
+    }
+    std::printf("\n");
+    return fixedPriority ? 0 : 1;
+}
+
+static int sweep(uint64_t sets, const sched::GeneratorConfig& config, uint64_t seed, uint32_t cores,
+                 PartitionHeuristic heuristic) {
+    sched::TaskSetGenerator generator(seed);
+    sched::TaskSet tasks;
+    sched::TaskSet dm;
+    std::vector<uint64_t> responseTimes(config.tasks);
+    std::vector<uint32_t> partition;
+    uint64_t rmOk = 0;
+    uint64_t dmOk = 0;
+    uint64_t edfOk = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t s = 0; s < sets; s++) {
+        generator.generate(config, tasks);
+        dm = tasks;
+        sched::assignPriorities(tasks, PRIORITY_RATE_MONOTONIC);
+        sched::assignPriorities(dm, PRIORITY_DEADLINE_MONOTONIC);
+        if (cores > 1) {
+            // accepted if the assigner finds a partition passing its per-core test
+            rmOk += sched::partitionTasks(tasks, cores, heuristic, false, partition);
+            dmOk += sched::partitionTasks(dm, cores, heuristic, false, partition);
+            edfOk += sched::partitionTasks(tasks, cores, heuristic, true, partition);
+            continue;
+        }
+        rmOk += sched::responseTimeAnalysis(tasks.data(), tasks.size(), responseTimes.data(), nullptr, true);
+        dmOk += sched::responseTimeAnalysis(dm.data(), dm.size(), responseTimes.data(), nullptr, true);
+        edfOk += sched::edfSchedulable(tasks);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%" PRIu64 " sets of %" PRIu32 " tasks at utilization %.3f (deadline ratio %.2f)\n", sets,
+                config.tasks, config.utilization, config.deadlineRatioMin);
+    if (cores > 1) {
+        std::printf("partitioned on %" PRIu32 " cores, %s\n", cores, heuristicName(heuristic));
+    }
+    std::printf("schedulable: RM %.4f, DM %.4f, EDF %.4f\n", double(rmOk) / sets, double(dmOk) / sets,
+                double(edfOk) / sets);
+    std::printf("%.0f task sets/s (generation and all three analyses)\n", sets / seconds);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    std::string tasksPath;
+    PriorityPolicy policy = PRIORITY_RATE_MONOTONIC;
+    uint64_t randomSets = 0;
+    uint64_t seed = 1;
+    sched::GeneratorConfig config;
+    uint32_t cores = 1;
+    PartitionHeuristic heuristic = PARTITION_FIRST_FIT_DECREASING;
+    bool withServer = false;
+    sched::Server server;
+    std::string resourcesPath;
+    bool withResources = true;
+    uint32_t mode = 0;
+    bool withMode = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--tasks" && hasValue) {
+            tasksPath = argv[++i];
+        } else if (arg == "--mode" && hasValue) {
+            mode = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            withMode = true;
+        } else if (arg == "--policy" && hasValue) {
+            if (!sched::parsePolicy(argv[++i], policy)) {
+                return usage(argv[0]);
+            }
+        } else if (arg == "--random" && hasValue) {
+            randomSets = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--n" && hasValue) {
+            config.tasks = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--utilization" && hasValue) {
+            config.utilization = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--deadline-ratio" && hasValue) {
+            config.deadlineRatioMin = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--seed" && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--cores" && hasValue) {
+            cores = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--heuristic" && hasValue) {
+            if (!sched::parseHeuristic(argv[++i], heuristic)) {
+                return usage(argv[0]);
+            }
+        } else if (arg == "--server" && hasValue) {
+            withServer = true;
+            if (!sched::parseServerPolicy(argv[++i], server.policy)) {
+                return usage(argv[0]);
+            }
+        } else if (arg == "--server-budget" && hasValue) {
+            server.budget = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--server-period" && hasValue) {
+            server.period = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--resources" && hasValue) {
+            resourcesPath = argv[++i];
+        } else if (arg == "--no-resources") {
+            withResources = false;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    if (cores == 0 || server.period == 0 || server.budget > server.period || mode >= taskModeCount ||
+        (withMode && !tasksPath.empty())) {
+        return usage(argv[0]);
+    }
+
+    if (randomSets > 0) {
+        return sweep(randomSets, config, seed, cores, heuristic);
+    }
+
+    sched::TaskSet tasks;
+    if (tasksPath.empty()) {
+        tasks = sched::firmwareTaskSet(policy, mode);
+    } else {
+        std::string error;
+        if (!sched::loadTaskSet(tasksPath, tasks, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        sched::assignPriorities(tasks, policy);
+    }
+    sched::ResourceSet resources;
+    if (!resourcesPath.empty()) {
+        std::string error;
+        if (!sched::loadResources(resourcesPath, resources, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+    } else if (tasksPath.empty()) {
+        resources = sched::firmwareResources();
+    }
+    if (!withResources) {
+        resources.clear();
+    }
+    return analyse(tasks, resources, policy, cores, heuristic, withServer ? &server : nullptr,
+                   tasksPath.empty() ? &taskModes[mode] : nullptr);
+}
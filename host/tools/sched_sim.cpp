@@ -0,0 +1,199 @@
+// Discrete-event simulation of the periodic task set under fixed-priority or
+// EDF scheduling, on one core or on several cores (partitioned or global).
+//
+// usage: sched_sim [--tasks tasks.csv] [--policy rm|dm|explicit|edf] [--cores N]
+//                  [--global] [--partition c0,c1,... | --heuristic ffd|wfd]
+//                  [--hyperperiods K | --duration US] [--trace out.csv|-] [--no-skip]
+//
+// Without --tasks the task table compiled into the firmware (taskTable.c) is
+// simulated. On several cores the tasks are partitioned by default, with the
+// assigner of the firmware (taskSetPartition, first fit unless --heuristic wfd)
+// unless --partition gives the core of every task. --trace writes every job start and completion in the layout of the
+// firmware's CSV dumps (RM.csv), with the core as a fourth column on more than
+// one core, ready for trace2json:
+//
+//   sched_sim --policy edf --hyperperiods 10 --trace edf.csv && trace2json edf.csv edf.json
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "sched/analysis.hpp"
+#include "sched/simulator.hpp"
+#include "sched/task.hpp"
+#include "trace/csv.hpp"
+
+static int usage(const char* program) {
+    std::fprintf(stderr,
+                 "usage: %s [--tasks tasks.csv] [--policy rm|dm|explicit|edf] [--cores N]\n"
+                 "          [--global] [--partition c0,c1,... | --heuristic ffd|wfd]\n"
+                 "          [--hyperperiods K | --duration US] [--trace out.csv|-] [--no-skip]\n",
+                 program);
+    return 2;
+}
+
+static bool parsePartition(const char* text, std::vector<uint32_t>& partition) {
+    partition.clear();
+    while (*text != '\0') {
+        char* end;
+        unsigned long core = std::strtoul(text, &end, 10);
+        if (end == text || (*end != ',' && *end != '\0')) {
+            return false;
+        }
+        partition.push_back(static_cast<uint32_t>(core));
+        text = *end == ',' ? end + 1 : end;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::string tasksPath;
+    std::string tracePath;
+    PriorityPolicy policy = PRIORITY_RATE_MONOTONIC;
+    sched::SimConfig config;
+    uint64_t hyperperiods = 1000;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--tasks" && hasValue) {
+            tasksPath = argv[++i];
+        } else if (arg == "--policy" && hasValue) {
+            std::string name = argv[++i];
+            if (name == "edf") {
+                config.policy = sched::SimPolicy::Edf;
+            } else if (!sched::parsePolicy(name, policy)) {
+                return usage(argv[0]);
+            }
+        } else if (arg == "--cores" && hasValue) {
+            config.cores = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--global") {
+            config.placement = sched::SimPlacement::Global;
+        } else if (arg == "--partition" && hasValue) {
+            if (!parsePartition(argv[++i], config.partition)) {
+                return usage(argv[0]);
+            }
+        } else if (arg == "--heuristic" && hasValue) {
+            if (!sched::parseHeuristic(argv[++i], config.heuristic)) {
+                return usage(argv[0]);
+            }
+        } else if (arg == "--hyperperiods" && hasValue) {
+            hyperperiods = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--duration" && hasValue) {
+            config.duration = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--trace" && hasValue) {
+            tracePath = argv[++i];
+        } else if (arg == "--no-skip") {
+            config.skipSteadyState = false;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (config.cores == 0) {
+        return usage(argv[0]);
+    }
+
+    sched::TaskSet tasks;
+    if (tasksPath.empty()) {
+        tasks = sched::firmwareTaskSet(policy);
+    } else {
+        std::string error;
+        if (!sched::loadTaskSet(tasksPath, tasks, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        sched::assignPriorities(tasks, policy);
+    }
+
+    uint64_t hyper = sched::hyperperiod(tasks);
+    if (config.duration == 0) {
+        if (hyper == sched::kUnbounded || hyper > sched::kUnbounded / hyperperiods) {
+            std::fprintf(stderr, "hyperperiod too long, give --duration\n");
+            return 1;
+        }
+        config.duration = hyper * hyperperiods;
+    }
+    if (config.placement == sched::SimPlacement::Partitioned && config.cores == 1) {
+        // nothing to place, and the assigner's EDF test is only sufficient
+        config.partition.assign(tasks.size(), 0);
+    } else if (config.placement == sched::SimPlacement::Partitioned) {
+        if (config.partition.empty()) {
+            if (!sched::partitionTasks(tasks, config.cores, config.heuristic, config.policy == sched::SimPolicy::Edf,
+                                       config.partition)) {
+                std::fprintf(stderr, "warning: the tasks do not fit on %" PRIu32 " cores\n", config.cores);
+            }
+        } else if (config.partition.size() != tasks.size()) {
+            std::fprintf(stderr, "--partition needs one core per task\n");
+            return 1;
+        }
+        for (uint32_t core : config.partition) {
+            if (core >= config.cores) {
+                std::fprintf(stderr, "--partition: no core %" PRIu32 "\n", core);
+                return 1;
+            }
+        }
+    }
+
+    std::FILE* traceFile = nullptr;
+    if (!tracePath.empty()) {
+        traceFile = tracePath == "-" ? stdout : std::fopen(tracePath.c_str(), "wb");
+        if (traceFile == nullptr) {
+            std::perror(tracePath.c_str());
+            return 1;
+        }
+    }
+
+    sched::Simulator simulator(tasks, config);
+    auto start = std::chrono::steady_clock::now();
+    const sched::SimStats* stats;
+    if (traceFile != nullptr) {
+        trace::CsvWriter writer(traceFile, config.cores > 1);
+        stats = &simulator.run(&writer);
+    } else {
+        stats = &simulator.run();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (traceFile != nullptr && traceFile != stdout) {
+        std::fclose(traceFile);
+    }
+
+    // the report goes to stderr when the trace goes to stdout
+    std::FILE* out = traceFile == stdout ? stderr : stdout;
+    std::fprintf(out, "%s, %" PRIu32 " core%s%s, %" PRIu64 " us simulated\n",
+                 config.policy == sched::SimPolicy::Edf ? "EDF" : "fixed priority", config.cores,
+                 config.cores > 1 ? "s" : "",
+                 config.cores == 1 ? "" : config.placement == sched::SimPlacement::Global ? " (global)"
+                                                                                           : " (partitioned)",
+                 stats->simulatedTime);
+    std::fprintf(out, "%6s %5s %5s %10s %10s %12s %12s %10s\n", "task", "prio", "core", "jobs", "missed",
+                 "max resp", "mean resp", "deadline");
+    for (size_t i = 0; i < tasks.size(); i++) {
+        const sched::SimTaskStats& task = stats->tasks[i];
+        char core[12] = "-";
+        if (config.placement == sched::SimPlacement::Partitioned) {
+            std::snprintf(core, sizeof(core), "%" PRIu32, config.partition[i]);
+        }
+        std::fprintf(out, "%6" PRIu32 " %5" PRIu32 " %5s %10" PRIu64 " %10" PRIu64 " %12" PRIu64 " %12.1f %10" PRIu64 "\n",
+                     tasks[i].id, tasks[i].priority, core, task.jobs, task.missed, task.maxResponse,
+                     task.jobs > 0 ? double(task.totalResponse) / task.jobs : 0.0, tasks[i].deadline);
+    }
+    std::fprintf(out, "\n%" PRIu64 " jobs, %" PRIu64 " missed, %" PRIu64 " preemptions, %" PRIu64 " migrations\n",
+                 stats->jobs, stats->missed, stats->preemptions, stats->migrations);
+    if (stats->cycle > 0) {
+        std::fprintf(out, "schedule repeats every %" PRIu64 " us\n", stats->cycle);
+    }
+    if (hyper != sched::kUnbounded) {
+        // the rate is of the hyperperiods actually simulated, the skipped ones cost nothing
+        uint64_t executed = stats->simulatedTime - stats->skippedTime;
+        std::fprintf(out, "%.0f hyperperiods simulated (%.0f/s)", double(executed) / double(hyper),
+                     double(executed) / double(hyper) / seconds);
+        if (stats->skippedTime > 0) {
+            std::fprintf(out, ", %.0f skipped", double(stats->skippedTime) / double(hyper));
+        }
+        std::fprintf(out, "\n");
+    }
+    return stats->missed == 0 ? 0 : 1;
+}
@@ -0,0 +1,374 @@
+// Breakdown utilization of task sets under the scheduling policies: the
+// execution times of a task set are scaled step by step, its periods and
+// deadlines kept, until it misses a deadline; the last utilization it was still
+// schedulable at is its breakdown utilization. Every policy gets the same task
+// sets, on every core count asked for.
+//
+// usage: sched_sweep [--sets N] [--n TASKS] [--period-min US] [--period-max US] [--granularity US]
+//                    [--deadline-ratio R] [--seed S] [--firmware | --tasks tasks.csv]
+//                    [--policies rm,dm,edf] [--cores 1,2] [--heuristic ffd|wfd]
+//                    [--sim [--global] [--hyperperiods K] [--duration US]]
+//                    [--step U] [--threads N] [--csv out.csv]
+//
+// By default N random task sets are drawn (UUniFast, log-uniform periods, see
+// generator.hpp); --firmware sweeps the task table compiled into the firmware
+// (taskTable.c) instead, --tasks a task set file. The utilization goes up by
+// --step (default 0.01) up to the number of cores.
+//
+// A scaled set is judged by the analysis of sched_analysis (response-time
+// analysis, the exact EDF test; on several cores the firmware's assigner,
+// taskSetPartition, has to place every task) or with --sim by the simulator of
+// sched_sim: released together at 0 and run for K hyperperiods (default 1), at
+// most --duration (default 10 s) when the hyperperiod is longer, a deadline
+// miss failing it. --global adds the global placement of the simulator on more
+// than one core. Blocking on shared resources is left out, like in the
+// simulator.
+//
+// The report gives, per policy and core count, the breakdown utilization over
+// the sets and the fraction of the sets still schedulable at every utilization;
+// --csv writes the breakdown of every set and policy for sweep.py, which plots
+// it, and also runs the sweep on the FreeRTOS POSIX build:
+//
+//   sched_sweep --sets 1000 --cores 1,2 --csv sweep.csv && python3 sweep.py plot sweep.csv
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sched/analysis.hpp"
+#include "sched/generator.hpp"
+#include "sched/simulator.hpp"
+#include "sched/task.hpp"
+
+static int usage(const char* program) {
+    std::fprintf(stderr,
+                 "usage: %s [--sets N] [--n TASKS] [--period-min US] [--period-max US] [--granularity US]\n"
+                 "          [--deadline-ratio R] [--seed S] [--firmware | --tasks tasks.csv]\n"
+                 "          [--policies rm,dm,edf] [--cores 1,2] [--heuristic ffd|wfd]\n"
+                 "          [--sim [--global] [--hyperperiods K] [--duration US]]\n"
+                 "          [--step U] [--threads N] [--csv out.csv]\n",
+                 program);
+    return 2;
+}
+
+// one column of the report: a policy on a number of cores
+struct Setup {
+    std::string policy;
+    bool edf = false;
+    PriorityPolicy priorities = PRIORITY_RATE_MONOTONIC;
+    uint32_t cores = 1;
+    bool global = false;
+
+    std::string name() const {
+        return policy + "/" + std::to_string(cores) + (global ? "g" : "");
+    }
+};
+
+struct SweepConfig {
+    std::vector<Setup> setups;
+    PartitionHeuristic heuristic = PARTITION_FIRST_FIT_DECREASING;
+    double step = 0.01;
+    bool simulate = false;
+    uint64_t hyperperiods = 1;
+    uint64_t maxDuration = 10000000;
+};
+
+static bool parseList(const char* text, std::vector<std::string>& items) {
+    items.clear();
+    std::string list = text;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        if (end == start) {
+            return false;
+        }
+        items.push_back(list.substr(start, end - start));
+        start = end + 1;
+    }
+    return !items.empty();
+}
+
+// `base` with its execution times scaled to a total utilization of `target`;
+// rounded down so that the scaled set never exceeds it
+static void scaleTo(const sched::TaskSet& base, double baseUtilization, double target, sched::TaskSet& tasks) {
+    tasks = base;
+    double factor = target / baseUtilization;
+    for (sched::Task& task : tasks) {
+        task.wcet = std::max<uint64_t>(1, static_cast<uint64_t>(std::floor(task.wcet * factor)));
+    }
+}
+
+static bool schedulable(const sched::TaskSet& tasks, const Setup& setup, const SweepConfig& config,
+                        std::vector<uint64_t>& responseTimes, std::vector<uint32_t>& partition) {
+    if (!config.simulate) {
+        if (setup.cores > 1) {
+            // accepted if the assigner finds a partition passing its per-core test
+            return sched::partitionTasks(tasks, setup.cores, config.heuristic, setup.edf, partition);
+        }
+        if (setup.edf) {
+            return sched::edfSchedulable(tasks);
+        }
+        responseTimes.resize(tasks.size());
+        return sched::responseTimeAnalysis(tasks.data(), tasks.size(), responseTimes.data(), nullptr, true);
+    }
+    sched::SimConfig sim;
+    sim.policy = setup.edf ? sched::SimPolicy::Edf : sched::SimPolicy::FixedPriority;
+    sim.cores = setup.cores;
+    sim.placement = setup.global ? sched::SimPlacement::Global : sched::SimPlacement::Partitioned;
+    // the simulator places the tasks like the firmware, fitting or not
+    sim.heuristic = config.heuristic;
+    uint64_t hyper = sched::hyperperiod(tasks);
+    sim.duration = hyper == sched::kUnbounded || hyper > config.maxDuration / config.hyperperiods
+                       ? config.maxDuration
+                       : hyper * config.hyperperiods;
+    sched::Simulator simulator(tasks, sim);
+    return simulator.run().missed == 0;
+}
+
+// highest utilization on the grid of `config.step` up to which `base` stays
+// schedulable under `setup`, 0 if it fails at the first step
+static double breakdown(const sched::TaskSet& base, const Setup& setup, const SweepConfig& config) {
+    double baseUtilization = sched::utilization(base);
+    sched::TaskSet tasks;
+    std::vector<uint64_t> responseTimes;
+    std::vector<uint32_t> partition;
+    double passed = 0;
+    for (uint32_t k = 1;; k++) {
+        double target = k * config.step;
+        if (target > setup.cores + 1e-9) {
+            break;
+        }
+        scaleTo(base, baseUtilization, target, tasks);
+        if (!schedulable(tasks, setup, config, responseTimes, partition)) {
+            break;
+        }
+        passed = target;
+    }
+    return passed;
+}
+
+static double percentile(std::vector<double> values, double fraction) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(fraction * static_cast<double>(values.size() - 1) + 0.5);
+    return values[index];
+}
+
+int main(int argc, char** argv) {
+    std::string tasksPath;
+    bool firmware = false;
+    uint64_t sets = 100;
+    uint64_t seed = 1;
+    sched::GeneratorConfig generatorConfig;
+    // the shares of the tasks, scaled from there
+    generatorConfig.utilization = 1.0;
+    std::vector<std::string> policies = {"rm", "dm", "edf"};
+    std::vector<std::string> coreCounts = {"1"};
+    bool global = false;
+    uint32_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string csvPath;
+    SweepConfig config;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--sets" && hasValue) {
+            sets = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--n" && hasValue) {
+            generatorConfig.tasks = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--period-min" && hasValue) {
+            generatorConfig.periodMin = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--period-max" && hasValue) {
+            generatorConfig.periodMax = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--granularity" && hasValue) {
+            generatorConfig.granularity = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--deadline-ratio" && hasValue) {
+            generatorConfig.deadlineRatioMin = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--seed" && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--firmware") {
+            firmware = true;
+        } else if (arg == "--tasks" && hasValue) {
+            tasksPath = argv[++i];
+        } else if (arg == "--policies" && hasValue) {
+            if (!parseList(argv[++i], policies)) {
+                return usage(argv[0]);
+            }
+        } else if (arg == "--cores" && hasValue) {
+            if (!parseList(argv[++i], coreCounts)) {
+                return usage(argv[0]);
+            }
+        } else if (arg == "--heuristic" && hasValue) {
+            if (!sched::parseHeuristic(argv[++i], config.heuristic)) {
+                return usage(argv[0]);
+            }
+        } else if (arg == "--sim") {
+            config.simulate = true;
+        } else if (arg == "--global") {
+            global = true;
+        } else if (arg == "--hyperperiods" && hasValue) {
+            config.hyperperiods = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--duration" && hasValue) {
+            config.maxDuration = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--step" && hasValue) {
+            config.step = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--threads" && hasValue) {
+            threads = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--csv" && hasValue) {
+            csvPath = argv[++i];
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (sets == 0 || generatorConfig.tasks == 0 || generatorConfig.granularity == 0 ||
+        generatorConfig.periodMin > generatorConfig.periodMax || !(config.step > 0) || threads == 0 ||
+        config.hyperperiods == 0 || (firmware && !tasksPath.empty()) || (global && !config.simulate)) {
+        return usage(argv[0]);
+    }
+    for (const std::string& count : coreCounts) {
+        uint32_t cores = static_cast<uint32_t>(std::strtoul(count.c_str(), nullptr, 10));
+        if (cores == 0) {
+            return usage(argv[0]);
+        }
+        for (const std::string& policy : policies) {
+            Setup setup;
+            setup.policy = policy;
+            setup.cores = cores;
+            setup.edf = policy == "edf";
+            if (!setup.edf && !sched::parsePolicy(policy, setup.priorities)) {
+                return usage(argv[0]);
+            }
+            config.setups.push_back(setup);
+            if (global && cores > 1) {
+                setup.global = true;
+                config.setups.push_back(setup);
+            }
+        }
+    }
+
+    // the task sets, generated up front so that the seed alone decides them
+    std::vector<sched::TaskSet> bases;
+    if (firmware) {
+        bases.push_back(sched::firmwareTaskSet(PRIORITY_EXPLICIT));
+    } else if (!tasksPath.empty()) {
+        bases.emplace_back();
+        std::string error;
+        if (!sched::loadTaskSet(tasksPath, bases.back(), error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+    } else {
+        sched::TaskSetGenerator generator(seed);
+        bases.resize(sets);
+        for (sched::TaskSet& tasks : bases) {
+            generator.generate(generatorConfig, tasks);
+        }
+    }
+
+    // breakdowns[set * setups + setup]
+    size_t setupCount = config.setups.size();
+    std::vector<double> breakdowns(bases.size() * setupCount);
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t job = next++; job < breakdowns.size(); job = next++) {
+            const Setup& setup = config.setups[job % setupCount];
+            sched::TaskSet tasks = bases[job / setupCount];
+            if (!setup.edf || setup.cores > 1) {
+                // the priorities do not depend on the execution times; the
+                // partitioned EDF assigner ignores them
+                sched::assignPriorities(tasks, setup.priorities);
+            }
+            breakdowns[job] = breakdown(tasks, setup, config);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (uint32_t t = 1; t < std::min<size_t>(threads, breakdowns.size()); t++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+
+    if (!csvPath.empty()) {
+        std::FILE* out = std::fopen(csvPath.c_str(), "w");
+        if (out == nullptr) {
+            std::perror(csvPath.c_str());
+            return 1;
+        }
+        std::fprintf(out, "set,policy,cores,placement,method,utilization,breakdown\n");
+        for (size_t s = 0; s < bases.size(); s++) {
+            for (size_t k = 0; k < setupCount; k++) {
+                const Setup& setup = config.setups[k];
+                std::fprintf(out, "%zu,%s,%" PRIu32 ",%s,%s,%.4f,%.4f\n", s, setup.policy.c_str(), setup.cores,
+                             setup.global ? "global" : "partitioned", config.simulate ? "sim" : "analysis",
+                             sched::utilization(bases[s]), breakdowns[s * setupCount + k]);
+            }
+        }
+        std::fclose(out);
+    }
+
+    std::printf("%zu task set%s, %s, utilization step %.3f\n\n", bases.size(), bases.size() == 1 ? "" : "s",
+                config.simulate ? "simulated" : "analysed", config.step);
+    if (bases.size() == 1) {
+        // one set: how far its own execution times stretch
+        double base = sched::utilization(bases[0]);
+        std::printf("utilization %.4f as given\n", base);
+        std::printf("%-8s %10s %10s\n", "policy", "breakdown", "scale");
+        for (size_t k = 0; k < setupCount; k++) {
+            std::printf("%-8s %10.3f %9.0f%%\n", config.setups[k].name().c_str(), breakdowns[k],
+                        100.0 * breakdowns[k] / base);
+        }
+        return 0;
+    }
+
+    std::printf("breakdown utilization:\n%-8s %8s %8s %8s %8s %8s\n", "policy", "mean", "min", "p10", "p50", "max");
+    std::vector<std::vector<double>> columns(setupCount);
+    for (size_t k = 0; k < setupCount; k++) {
+        for (size_t s = 0; s < bases.size(); s++) {
+            columns[k].push_back(breakdowns[s * setupCount + k]);
+        }
+        const std::vector<double>& column = columns[k];
+        double mean = 0;
+        for (double value : column) {
+            mean += value;
+        }
+        mean /= static_cast<double>(column.size());
+        std::printf("%-8s %8.3f %8.3f %8.3f %8.3f %8.3f\n", config.setups[k].name().c_str(), mean,
+                    percentile(column, 0), percentile(column, 0.1), percentile(column, 0.5), percentile(column, 1));
+    }
+
+    // acceptance: the sets whose breakdown is at least the utilization, every
+    // tenth of a core
+    std::printf("\nschedulable sets:\n%-8s", "U");
+    for (const Setup& setup : config.setups) {
+        std::printf(" %8s", setup.name().c_str());
+    }
+    std::printf("\n");
+    uint32_t maxCores = 1;
+    for (const Setup& setup : config.setups) {
+        maxCores = std::max(maxCores, setup.cores);
+    }
+    for (uint32_t tenth = 1; tenth <= 10 * maxCores; tenth++) {
+        double target = tenth / 10.0;
+        std::printf("%-8.1f", target);
+        for (size_t k = 0; k < setupCount; k++) {
+            size_t accepted = std::count_if(columns[k].begin(), columns[k].end(),
+                                            [&](double value) { return value >= target - 1e-9; });
+            std::printf(" %7.1f%%", 100.0 * accepted / columns[k].size());
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,90 @@
+// Turns the framed binary trace stream of the firmware (TRACE_OUTPUT_BINARY)
+// back into the `task,event,timestamp` CSV layout, e.g. to feed data_proc.py.
+//
+// usage: trace2csv [--no-merge] [--cores N] [--core] [input.bin|-] [output.csv|-]
+//
+//   --cores N   number of cores that log (configNUM_CORES, default 2)
+//   --no-merge  keep the events in frame order instead of merging the cores by timestamp
+//   --core      append the core that logged the event as a fourth column
+//
+// Input defaults to stdin and output to stdout. The input may be a raw capture
+// of the USB serial port: console text between the frames is skipped. Decoding
+// statistics go to stderr.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "trace/csv.hpp"
+#include "trace/decoder.hpp"
+
+int main(int argc, char** argv) {
+    bool merge = true;
+    bool withCore = false;
+    uint32_t cores = 2;
+    const char* inputPath = "-";
+    const char* outputPath = "-";
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--no-merge") == 0) {
+            merge = false;
+        } else if (std::strcmp(argv[i], "--cores") == 0 && i + 1 < argc) {
+            cores = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--core") == 0) {
+            withCore = true;
+        } else if (positional == 0) {
+            inputPath = argv[i];
+            positional++;
+        } else if (positional == 1) {
+            outputPath = argv[i];
+            positional++;
+        } else {
+            std::fprintf(stderr, "usage: %s [--no-merge] [--cores N] [--core] [input.bin|-] [output.csv|-]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::FILE* in = std::strcmp(inputPath, "-") == 0 ? stdin : std::fopen(inputPath, "rb");
+    if (in == nullptr) {
+        std::perror(inputPath);
+        return 1;
+    }
+    std::FILE* out = std::strcmp(outputPath, "-") == 0 ? stdout : std::fopen(outputPath, "w");
+    if (out == nullptr) {
+        std::perror(outputPath);
+        return 1;
+    }
+
+    trace::CsvWriter writer(out, withCore);
+    trace::CoreMerger merger(writer, cores > 0 ? cores : 1);
+    trace::FrameDecoder decoder(merge ? static_cast<trace::EventSink&>(merger) : writer);
+
+    std::vector<uint8_t> chunk(size_t(1) << 20);
+    size_t n;
+    while ((n = std::fread(chunk.data(), 1, chunk.size(), in)) > 0) {
+        decoder.feed(chunk.data(), n);
+    }
+    decoder.finish();
+
+    const trace::DecoderStats& stats = decoder.stats();
+    std::fprintf(stderr,
+                 "%llu bytes, %llu frames, %llu events, %llu lost frames, %llu CRC errors, "
+                 "%llu bad frames, %llu bytes skipped\n",
+                 (unsigned long long)stats.bytes, (unsigned long long)stats.frames,
+                 (unsigned long long)stats.records, (unsigned long long)stats.lostFrames,
+                 (unsigned long long)stats.crcErrors, (unsigned long long)stats.badFrames,
+                 (unsigned long long)stats.skippedBytes);
+    if (stats.lossRecords > 0) {
+        std::fprintf(stderr, "%llu events lost in %llu gaps (the target's rings were full), kept as loss records\n",
+                     (unsigned long long)stats.lostEvents, (unsigned long long)stats.lossRecords);
+    }
+
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    if (in != stdin) {
+        std::fclose(in);
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+// Converts a trace (CSV `task,event,timestamp[,core]` or the framed binary
+// stream) into Chrome trace / Perfetto JSON, rebuilding preemptions like
+// data_proc.py, or taking them from the kernel's switch events when the trace
+// has them (TRACE_KERNEL_EVENTS). Runs in a single pass with constant memory, so captures of any
+// size convert at disk speed. Inconsistencies in the trace are reported and
+// repaired instead of stopping the conversion.
+//
+// usage: trace2json [--csv|--binary] [--per-core] [--ms] [--cores N] [input|-] [output.json|-]
+//
+//   --csv, --binary  input format (default: detected from the content)
+//   --per-core       one track per core instead of one per task; preemptions are
+//                    rebuilt per core, which needs the core of every event
+//                    (binary input, or CSV with a fourth column)
+//   --ms             timestamps are in milliseconds (captures made before the
+//                    microsecond timestamps, such as RM.csv)
+//   --cores N        number of cores that log in a binary trace (default 2)
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "trace/chrome.hpp"
+#include "trace/input.hpp"
+#include "trace/preemption.hpp"
+
+static int usage(const char* program) {
+    std::fprintf(stderr,
+                 "usage: %s [--csv|--binary] [--per-core] [--ms] [--cores N] [input|-] [output.json|-]\n",
+                 program);
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    trace::InputFormat format = trace::InputFormat::Auto;
+    bool perCore = false;
+    uint64_t timestampScale = 1;
+    uint32_t cores = 2;
+    std::string inputPath = "-";
+    std::string outputPath = "-";
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--csv") == 0) {
+            format = trace::InputFormat::Csv;
+        } else if (std::strcmp(argv[i], "--binary") == 0) {
+            format = trace::InputFormat::Binary;
+        } else if (std::strcmp(argv[i], "--per-core") == 0) {
+            perCore = true;
+        } else if (std::strcmp(argv[i], "--ms") == 0) {
+            timestampScale = 1000;
+        } else if (std::strcmp(argv[i], "--cores") == 0 && i + 1 < argc) {
+            cores = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            return usage(argv[0]);
+        } else if (positional == 0) {
+            inputPath = argv[i];
+            positional++;
+        } else if (positional == 1) {
+            outputPath = argv[i];
+            positional++;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    std::FILE* out = outputPath == "-" ? stdout : std::fopen(outputPath.c_str(), "w");
+    if (out == nullptr) {
+        std::perror(outputPath.c_str());
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    trace::ChromeJsonWriter writer(out, perCore, timestampScale);
+    trace::PreemptionBuilder builder(writer, perCore);
+    trace::InputStats input;
+    if (!trace::readTrace(inputPath, format, builder, input, cores > 0 ? cores : 1)) {
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const trace::PreemptionStats& stats = builder.stats();
+    trace::printInputStats(inputPath.c_str(), input);
+    std::fprintf(stderr,
+                 "%llu events -> %llu slice events, %llu preemptions, %llu zero-length slices dropped, "
+                 "%llu slices open at the end\n",
+                 (unsigned long long)stats.events, (unsigned long long)stats.slices,
+                 (unsigned long long)stats.preemptions, (unsigned long long)stats.zeroLength,
+                 (unsigned long long)stats.openAtEnd);
+    if (stats.switches > 0) {
+        std::fprintf(stderr, "%llu context switches from the kernel trace\n", (unsigned long long)stats.switches);
+    }
+    if (stats.lossRecords > 0) {
+        std::fprintf(stderr, "%llu events lost in %llu gaps (the target's rings were full)\n",
+                     (unsigned long long)stats.lostEvents, (unsigned long long)stats.lossRecords);
+    }
+    std::fprintf(stderr,
+                 "anomalies: %llu completions without start, %llu completions of a preempted task, "
+                 "%llu restarts of an active task\n",
+                 (unsigned long long)stats.endWithoutStart, (unsigned long long)stats.endNotRunning,
+                 (unsigned long long)stats.startWhileActive);
+    std::fprintf(stderr, "%.1f MB/s\n", seconds > 0 ? input.bytes / seconds / 1e6 : 0.0);
+
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    return 0;
+}
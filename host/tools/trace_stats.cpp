@@ -0,0 +1,374 @@
+// Job-level analytics of traces (CSV `task,event,timestamp[,core]` or the framed
+// binary stream): rebuilds every job from its start and completion events and
+// reports, per task, the jobs, deadline misses, preemptions, CPU time and the
+// distribution of response times, and per trace the CPU utilization, idle time
+// and busy periods. The measured response times are checked against the
+// analytical worst case of the task set (fixed-priority response-time analysis,
+// or the deadline under EDF when the EDF test passes); every job above it is
+// flagged and makes the exit status 1.
+//
+// usage: trace_stats [--tasks tasks.csv | --mode N] [--policy rm|dm|explicit|edf] [--cores N]
+//                    [--heuristic ffd|wfd] [--csv|--binary] [--ms] [--jobs] [--threads N]
+//                    [--resources resources.csv | --no-resources]
+//                    [--server polling|deferrable|sporadic [--server-budget US] [--server-period US]]
+//                    trace...
+//
+//   --tasks       task set of the trace (default: the firmware's taskTable.c)
+//   --mode N      task set of operating mode N of the firmware (modeTable.c);
+//                 after a mode change the jobs are rephased, but still judged
+//                 against the bounds of this mode
+//   --policy      scheduling policy the trace was recorded under (default rm)
+//   --cores N     cores that log, and the partitioned analysis when N > 1
+//                 (PERIODIC_PLACEMENT_PARTITIONED, default 1)
+//   --ms          timestamps are in milliseconds (captures such as RM.csv)
+//   --jobs        write every job to <trace>.jobs.csv
+//   --threads N   traces analysed in parallel (default: one per hardware thread)
+//   --server      the trace ran with the aperiodic server (aperiodicServer.h), whose
+//                 interference enters the worst cases like in sched_analysis; its
+//                 own executions are listed as task APERIODIC_SERVER_TASK_ID
+//   --resources   shared resources of the task set, whose blocking enters the
+//                 fixed-priority worst cases like in sched_analysis (default: the
+//                 firmware's resourceTable.c with its task table, none with
+//                 --tasks); --no-resources for traces recorded without them
+//
+// Every trace is read in a single pass, memory-mapped when it is a regular file,
+// with memory proportional to the number of tasks; several traces are spread
+// over the threads and reported in the order of the command line.
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sched/analysis.hpp"
+#include "sched/task.hpp"
+#include "trace/analytics.hpp"
+#include "trace/input.hpp"
+
+// flagged jobs printed per trace, the rest are only counted
+static const uint32_t kFlaggedShown = 10;
+
+static int usage(const char* program) {
+    std::fprintf(stderr,
+                 "usage: %s [--tasks tasks.csv | --mode N] [--policy rm|dm|explicit|edf] [--cores N]\n"
+                 "          [--heuristic ffd|wfd] [--csv|--binary] [--ms] [--jobs] [--threads N]\n"
+                 "          [--resources resources.csv | --no-resources]\n"
+                 "          [--server polling|deferrable|sporadic [--server-budget US] [--server-period US]]\n"
+                 "          trace...\n",
+                 program);
+    return 2;
+}
+
+// writes the jobs to CSV and keeps the first ones above their bound
+class JobWriter : public trace::JobSink {
+public:
+    explicit JobWriter(std::FILE* out) : out_(out) {
+        if (out_ != nullptr) {
+            std::fprintf(out_, "core,task,job,release,start,completion,response,preemptions,met,exceeds_wcrt\n");
+        }
+    }
+
+    void onJob(const trace::Job& job) override {
+        if (out_ != nullptr) {
+            std::fprintf(out_, "%" PRIu32 ",%" PRIu32 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
+                               ",%" PRIu32 ",%d,%d\n",
+                         job.core, job.taskNum, job.index, job.release, job.start, job.completion,
+                         job.completion - job.release, job.preemptions, job.met, job.exceedsBound);
+        }
+        if (job.exceedsBound && flagged_.size() < kFlaggedShown) {
+            flagged_.push_back(job);
+        }
+    }
+
+    const std::vector<trace::Job>& flagged() const { return flagged_; }
+
+private:
+    std::FILE* out_;
+    std::vector<trace::Job> flagged_;
+};
+
+// everything printed about one trace, filled in by a worker thread
+struct Report {
+    std::string path;
+    bool ok = false;
+    trace::InputStats input;
+    trace::AnalyticsSummary summary;
+    std::vector<trace::Job> flagged;
+};
+
+static void analyseTrace(Report& report, const std::vector<trace::TaskBound>& bounds, trace::InputFormat format,
+                         uint64_t timestampScale, uint32_t cores, bool writeJobs) {
+    std::FILE* jobsOut = nullptr;
+    if (writeJobs) {
+        std::string jobsPath = (report.path == "-" ? std::string("stdin") : report.path) + ".jobs.csv";
+        jobsOut = std::fopen(jobsPath.c_str(), "w");
+        if (jobsOut == nullptr) {
+            std::perror(jobsPath.c_str());
+            return;
+        }
+    }
+    JobWriter writer(jobsOut);
+    trace::JobAnalyzer analyzer(bounds, timestampScale, &writer);
+    // a single-core trace still goes through the merger of two cores (the default of the other tools)
+    report.ok = trace::readTrace(report.path, format, analyzer, report.input, std::max<uint32_t>(cores, 2));
+    report.summary = analyzer.summary();
+    report.flagged = writer.flagged();
+    if (jobsOut != nullptr) {
+        std::fclose(jobsOut);
+    }
+}
+
+static double percent(uint64_t part, uint64_t whole) {
+    return whole > 0 ? 100.0 * double(part) / double(whole) : 0.0;
+}
+
+static void printReport(const Report& report, const std::vector<trace::TaskBound>& bounds) {
+    const trace::AnalyticsSummary& s = report.summary;
+    trace::printInputStats(report.path.c_str(), report.input);
+    uint64_t capacity = s.span() * s.cores;
+    std::printf("%s: %" PRIu64 " us on %" PRIu32 " core(s), busy %" PRIu64 " us (%.2f%%), idle %" PRIu64
+                " us, %" PRIu64 " busy periods, longest %" PRIu64 " us\n",
+                report.path.c_str(), s.span(), s.cores, s.busyTime, percent(s.busyTime, capacity),
+                capacity > s.busyTime ? capacity - s.busyTime : 0, s.busyPeriods, s.longestBusyPeriod);
+    std::printf("%6s %8s %7s %7s %8s %11s %7s %8s %8s %8s %8s %8s %8s %8s\n", "task", "jobs", "missed", ">wcrt",
+                "preempt", "cpu", "util%", "min", "mean", "p50", "p99", "max", "wcrt", "deadline");
+    for (const trace::TaskSummary& task : s.tasks) {
+        char wcrt[24] = "-";
+        char deadline[24] = "-";
+        for (const trace::TaskBound& bound : bounds) {
+            if (bound.id == task.taskNum) {
+                if (bound.wcrt == UINT64_MAX) {
+                    std::snprintf(wcrt, sizeof(wcrt), "unbnd");
+                } else {
+                    std::snprintf(wcrt, sizeof(wcrt), "%" PRIu64, bound.wcrt);
+                }
+                std::snprintf(deadline, sizeof(deadline), "%" PRIu64, bound.deadline);
+            }
+        }
+        const LatencyHistogram* response = &task.response;
+        std::printf("%6" PRIu32 " %8" PRIu64 " %7" PRIu64 " %7" PRIu64 " %8" PRIu64 " %11" PRIu64
+                    " %7.2f %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu64 " %8s %8s\n",
+                    task.taskNum, task.jobs, task.missed, task.exceeded, task.preemptions, task.cpuTime,
+                    percent(task.cpuTime, capacity), response->count > 0 ? response->min : 0,
+                    latencyHistogramMean(response), latencyHistogramPercentile(response, 500),
+                    latencyHistogramPercentile(response, 990), task.maxResponse, wcrt, deadline);
+    }
+    std::printf("%" PRIu64 " jobs, %" PRIu64 " deadline misses, %" PRIu64 " above the analytical worst case\n",
+                s.jobs, s.missed, s.exceeded);
+    if (s.aborted > 0 || s.skipped > 0) {
+        std::printf("deadline watchdog: %" PRIu64 " jobs aborted, %" PRIu64 " releases skipped\n", s.aborted,
+                    s.skipped);
+    }
+    if (s.modeChanges > 0) {
+        std::printf("%" PRIu64 " mode changes\n", s.modeChanges);
+    }
+    if (s.lostEvents > 0) {
+        std::fprintf(stderr, "%s: %" PRIu64 " events lost on target, the jobs around them are approximate\n",
+                     report.path.c_str(), s.lostEvents);
+    }
+    if (s.anomalies > 0 || s.openJobs > 0) {
+        std::fprintf(stderr, "%s: %" PRIu64 " inconsistent events, %" PRIu64 " jobs still running at the end\n",
+                     report.path.c_str(), s.anomalies, s.openJobs);
+    }
+    for (const trace::Job& job : report.flagged) {
+        std::fprintf(stderr,
+                     "%s: task %" PRIu32 " job %" PRIu64 " released at %" PRIu64 " responded in %" PRIu64
+                     " us, above its worst case\n",
+                     report.path.c_str(), job.taskNum, job.index, job.release, job.completion - job.release);
+    }
+    if (s.exceeded > report.flagged.size()) {
+        std::fprintf(stderr, "%s: ... and %" PRIu64 " more\n", report.path.c_str(),
+                     s.exceeded - report.flagged.size());
+    }
+    std::printf("\n");
+}
+
+// the analytical worst case of every task of `periodic`, on `cores` cores
+static std::vector<trace::TaskBound> taskBounds(const sched::TaskSet& periodic, const sched::ResourceSet& resources,
+                                                bool edf, uint32_t cores, PartitionHeuristic heuristic,
+                                                const sched::Server* server) {
+    std::vector<uint32_t> partition(periodic.size(), 0);
+    if (cores > 1) {
+        sched::partitionTasks(periodic, cores, heuristic, edf, partition);
+    }
+    sched::TaskSet tasks = periodic;
+    if (server != nullptr) {
+        tasks.push_back(sched::serverTask(*server, periodic));
+        for (const sched::Task& task : sched::systemTasks(tasks.back())) {
+            tasks.push_back(task);
+        }
+        partition.resize(tasks.size(), cores > 1 ? APERIODIC_SERVER_CORE : 0);
+    }
+    std::vector<trace::TaskBound> bounds(tasks.size());
+    for (size_t i = 0; i < tasks.size(); i++) {
+        bounds[i].id = tasks[i].id;
+        bounds[i].period = tasks[i].period;
+        bounds[i].deadline = tasks[i].deadline;
+    }
+    for (uint32_t core = 0; core < cores; core++) {
+        sched::TaskSet onCore;
+        std::vector<size_t> members;
+        for (size_t i = 0; i < tasks.size(); i++) {
+            if (partition[i] == core) {
+                onCore.push_back(tasks[i]);
+                members.push_back(i);
+            }
+        }
+        if (edf) {
+            // EDF guarantees the deadlines of a schedulable set, nothing otherwise;
+            // a server above the EDF tasks is not covered by the test
+            bool schedulable = server == nullptr && sched::edfSchedulable(onCore);
+            for (size_t i : members) {
+                bounds[i].wcrt = schedulable ? tasks[i].deadline : UINT64_MAX;
+            }
+            continue;
+        }
+        std::vector<uint64_t> responseTimes(onCore.size());
+        std::vector<uint64_t> blocking = sched::blockingTerms(onCore, resources);
+        sched::responseTimeAnalysis(onCore.data(), onCore.size(), responseTimes.data(), blocking.data());
+        for (size_t k = 0; k < members.size(); k++) {
+            bounds[members[k]].wcrt = responseTimes[k];
+        }
+    }
+    if (server != nullptr) {
+        // the server's executions are not periodic jobs, the tasks above it not logged
+        bounds.resize(periodic.size());
+    }
+    return bounds;
+}
+
+int main(int argc, char** argv) {
+    std::string tasksPath;
+    PriorityPolicy policy = PRIORITY_RATE_MONOTONIC;
+    bool edf = false;
+    uint32_t cores = 1;
+    PartitionHeuristic heuristic = PARTITION_FIRST_FIT_DECREASING;
+    trace::InputFormat format = trace::InputFormat::Auto;
+    uint64_t timestampScale = 1;
+    bool writeJobs = false;
+    uint32_t threads = std::max(1u, std::thread::hardware_concurrency());
+    bool withServer = false;
+    sched::Server server;
+    std::string resourcesPath;
+    bool withResources = true;
+    uint32_t mode = 0;
+    bool withMode = false;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--tasks" && hasValue) {
+            tasksPath = argv[++i];
+        } else if (arg == "--mode" && hasValue) {
+            mode = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            withMode = true;
+        } else if (arg == "--policy" && hasValue) {
+            std::string name = argv[++i];
+            edf = name == "edf";
+            if (!edf && !sched::parsePolicy(name, policy)) {
+                return usage(argv[0]);
+            }
+        } else if (arg == "--cores" && hasValue) {
+            cores = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--heuristic" && hasValue) {
+            if (!sched::parseHeuristic(argv[++i], heuristic)) {
+                return usage(argv[0]);
+            }
+        } else if (arg == "--csv") {
+            format = trace::InputFormat::Csv;
+        } else if (arg == "--binary") {
+            format = trace::InputFormat::Binary;
+        } else if (arg == "--ms") {
+            timestampScale = 1000;
+        } else if (arg == "--jobs") {
+            writeJobs = true;
+        } else if (arg == "--threads" && hasValue) {
+            threads = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--server" && hasValue) {
+            withServer = true;
+            if (!sched::parseServerPolicy(argv[++i], server.policy)) {
+                return usage(argv[0]);
+            }
+        } else if (arg == "--server-budget" && hasValue) {
+            server.budget = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--server-period" && hasValue) {
+            server.period = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--resources" && hasValue) {
+            resourcesPath = argv[++i];
+        } else if (arg == "--no-resources") {
+            withResources = false;
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            return usage(argv[0]);
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.empty() || cores == 0 || threads == 0 || server.period == 0 || server.budget > server.period ||
+        mode >= taskModeCount || (withMode && !tasksPath.empty())) {
+        return usage(argv[0]);
+    }
+
+    sched::TaskSet tasks;
+    if (tasksPath.empty()) {
+        tasks = sched::firmwareTaskSet(policy, mode);
+    } else {
+        std::string error;
+        if (!sched::loadTaskSet(tasksPath, tasks, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        sched::assignPriorities(tasks, policy);
+    }
+    sched::ResourceSet resources;
+    if (!resourcesPath.empty()) {
+        std::string error;
+        if (!sched::loadResources(resourcesPath, resources, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+    } else if (tasksPath.empty()) {
+        resources = sched::firmwareResources();
+    }
+    if (!withResources) {
+        resources.clear();
+    }
+    std::vector<trace::TaskBound> bounds =
+        taskBounds(tasks, resources, edf, cores, heuristic, withServer ? &server : nullptr);
+
+    std::vector<Report> reports(paths.size());
+    for (size_t i = 0; i < paths.size(); i++) {
+        reports[i].path = paths[i];
+    }
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < reports.size(); i = next++) {
+            analyseTrace(reports[i], bounds, format, timestampScale, cores, writeJobs);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (uint32_t t = 1; t < std::min<size_t>(threads, reports.size()); t++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+
+    int status = 0;
+    for (const Report& report : reports) {
+        if (!report.ok) {
+            status = status == 0 ? 1 : status;
+            continue;
+        }
+        printReport(report, bounds);
+        if (report.summary.exceeded > 0) {
+            status = 1;
+        }
+    }
+    return status;
+}
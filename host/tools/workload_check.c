@@ -0,0 +1,60 @@
+// Accuracy check of the synthetic workload: calibrates it the way the firmware
+// does at startup, then runs jobs of several lengths and compares them with the
+// clock. Also draws from a uniform model to show its mean.
+//
+// usage: workload_check [runs per length]
+//
+// On a loaded or frequency-scaling host the measured lengths only get longer,
+// so look at the minimum error.
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "utils/timestamp.h"
+#include "utils/workload.h"
+
+static const uint32_t lengthsUs[] = {10, 50, 100, 500, 1000, 5000, 20000};
+
+int main(int argc, char **argv) {
+    uint32_t runs = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 50;
+    if (runs == 0) {
+        runs = 1;
+    }
+
+    Timestamp start = timestampNow();
+    workloadCalibrate();
+    printf("calibrated in %" PRIu64 " us: %" PRIu32 " loops/ms\n\n", timestampNow() - start, workloadLoopsPerMs());
+
+    printf("%10s %12s %12s %12s\n", "length us", "min us", "mean us", "min error");
+    for (size_t i = 0; i < sizeof(lengthsUs) / sizeof(lengthsUs[0]); i++) {
+        Timestamp min = UINT64_MAX;
+        Timestamp total = 0;
+        for (uint32_t r = 0; r < runs; r++) {
+            Timestamp t0 = timestampNow();
+            workloadRun(lengthsUs[i]);
+            Timestamp elapsed = timestampNow() - t0;
+            total += elapsed;
+            if (elapsed < min) {
+                min = elapsed;
+            }
+        }
+        printf("%10" PRIu32 " %12" PRIu64 " %12.1f %11.1f%%\n", lengthsUs[i], min, (double)total / runs,
+               100.0 * ((double)min - lengthsUs[i]) / lengthsUs[i]);
+    }
+
+    static const WorkloadModel uniform = {WORKLOAD_UNIFORM, 1000, 3000, NULL, 0};
+    WorkloadSequence sequence;
+    workloadSequenceInit(&sequence, &uniform, 3000, 3);
+    uint64_t sum = 0;
+    uint32_t lo = UINT32_MAX;
+    uint32_t hi = 0;
+    for (int i = 0; i < 100000; i++) {
+        uint32_t us = workloadSequenceNext(&sequence);
+        sum += us;
+        lo = us < lo ? us : lo;
+        hi = us > hi ? us : hi;
+    }
+    printf("\nuniform [1000, 3000] us: mean %.1f, range [%" PRIu32 ", %" PRIu32 "]\n", sum / 100000.0, lo, hi);
+    return 0;
+}
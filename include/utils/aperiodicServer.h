@@ -0,0 +1,120 @@
+#ifndef APERIODIC_SERVER_H
+#define APERIODIC_SERVER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils/latencyHistogram.h"
+#include "utils/taskSet.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Aperiodic and background work runs through a server: one task above every
+// periodic task that executes the submitted requests in order, but never for
+// more than APERIODIC_SERVER_BUDGET_US within a replenishment period of
+// APERIODIC_SERVER_PERIOD_US. Seen from the periodic tasks it is one more task
+// of the highest priority, with wcet = budget and period = replenishment period,
+// so its interference is bounded and taken into account by the analysis
+// (`sched_analysis --server`, which also gives the largest budget the task set
+// can afford). Only the console and the timer service task run above it, with
+// the bounds of systemTasks.h, and the analysis counts them too. Kept free of
+// FreeRTOS so that the host tools read the same configuration.
+//
+// The policies differ in when the budget comes back, and so in how fast a
+// request is served and in what the periodic tasks see:
+//   polling     the budget is refilled at every period and given up as soon as
+//               the queue is found empty: a request arriving afterwards waits
+//               for the next period. Interferes like a periodic task
+//   deferrable  the budget is refilled at every period and kept while idle: a
+//               request is served at once if budget is left. It can run at the
+//               end of one period and again at the start of the next, so it
+//               interferes like a periodic task with a release jitter of
+//               period - budget
+//   sporadic    the budget consumed from the moment the server becomes active
+//               comes back one period after that moment: served at once like
+//               deferrable, interferes like a periodic task
+//
+// A request either runs a handler, whose declared cost must fit in the budget
+// left before it is started, or (no handler) is synthetic CPU load of the given
+// length (workload.h), run in as many pieces as the budget requires. The time
+// actually taken is charged to the budget. Each piece of execution is logged as
+// a job of task APERIODIC_SERVER_TASK_ID.
+
+#define APERIODIC_SERVER_POLLING 0
+#define APERIODIC_SERVER_DEFERRABLE 1
+#define APERIODIC_SERVER_SPORADIC 2
+
+// ========= Configuration parameters ========
+
+#ifndef APERIODIC_SERVER_POLICY
+#define APERIODIC_SERVER_POLICY APERIODIC_SERVER_SPORADIC
+#endif
+// execution time available in each replenishment period, in microseconds. 20%
+// of the processor carries the load of highPrioTask.h (100 ms every 700 ms,
+// 14.3%) with room to spare; a server below the load it is given falls behind
+// for good, and rejects requests once its queue is full. With it the default
+// task set is overloaded (0.8 + 0.2): under fixed priority task 4 misses its
+// deadline even without the server, so the analysis finds no budget that fits,
+// while the degraded mode of modeTable.c affords up to 28.5%
+#ifndef APERIODIC_SERVER_BUDGET_US
+#define APERIODIC_SERVER_BUDGET_US TASK_MS(2)
+#endif
+#ifndef APERIODIC_SERVER_PERIOD_US
+#define APERIODIC_SERVER_PERIOD_US TASK_MS(10)
+#endif
+// above every periodic task (PERIODIC_BASE_PRIORITY and up)
+#define APERIODIC_SERVER_PRIORITY (configMAX_PRIORITIES - 4)
+// requests waiting at most; aperiodicSubmit() fails beyond
+#define APERIODIC_QUEUE_LENGTH 16
+// sporadic: pending replenishments at most, further ones are merged into the
+// last one (which only delays budget)
+#define APERIODIC_MAX_REPLENISHMENTS 8
+// task number of the server in the trace
+#define APERIODIC_SERVER_TASK_ID 100
+// stack depth (in words) of the server, the handlers run on it
+#define APERIODIC_SERVER_STACK_SIZE 512
+// with PERIODIC_PLACEMENT_PARTITIONED the server is pinned to this core; the
+// partitioning of the periodic tasks does not account for it
+#define APERIODIC_SERVER_CORE 0
+
+// ===== End of configuration parameters =====
+
+typedef void (*AperiodicHandler)(void *arg);
+
+// Served requests and their response times.
+typedef struct {
+    uint32_t submitted;
+    uint32_t served;
+    // queue full, or a handler costing more than the whole budget
+    uint32_t rejected;
+    // handlers that took longer than their declared cost
+    uint32_t overruns;
+    // times pending work waited for a replenishment
+    uint32_t budgetExhausted;
+    // execution time charged to the budget
+    uint64_t busyUs;
+    // completion - submission, microseconds
+    LatencyHistogram response;
+} AperiodicStats;
+
+// create the server task and its queue; call before starting the scheduler
+void createAperiodicServer(void);
+// queue a request: `handler(arg)`, declared to take at most `costUs`, or with
+// no handler `costUs` of synthetic load. Never blocks; returns false if the
+// request is rejected
+bool aperiodicSubmit(AperiodicHandler handler, void *arg, uint32_t costUs);
+// the same from an interrupt; `*yield` is set when the server is to run on
+// return (portYIELD_FROM_ISR)
+bool aperiodicSubmitFromISR(AperiodicHandler handler, void *arg, uint32_t costUs, bool *yield);
+// copy the statistics of the server so far into `stats`; the histogram is
+// written by the server without locking, a copy may mix two requests
+void getAperiodicStats(AperiodicStats *stats);
+// print the statistics of the server on one line
+void reportAperiodicStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // APERIODIC_SERVER_H
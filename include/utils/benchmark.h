@@ -0,0 +1,42 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <stdint.h>
+
+// Microbenchmarks of the primitives on the critical path of every job: the
+// trace loggers, xTaskDelayUntil(), a context switch, a mutex take/give. Each
+// one is sampled BENCHMARK_SAMPLES times; the report gives min, median and max
+// per primitive, in processor cycles on target (SysTick, core 0) and in
+// nanoseconds on the host (CLOCK_MONOTONIC).
+//
+// The loggers compared:
+//   ring     logEvent(): lock-free push into the per-core ring (traces.c)
+//   mutex    the former logger: array entry written under a FreeRTOS mutex
+//   critical array entry written in a kernel critical section
+//
+// The `timer` row is the cost of reading the timer twice, it is included in
+// every other row.
+
+// ========= Configuration parameters ========
+
+// samples per primitive
+#define BENCHMARK_SAMPLES 1000
+// BENCHMARK_OUTPUT_CSV prints `name,unit,samples,min,median,max` lines between
+// markers, BENCHMARK_OUTPUT_JSON a single JSON object
+#define BENCHMARK_OUTPUT_CSV 0
+#define BENCHMARK_OUTPUT_JSON 1
+#ifndef BENCHMARK_OUTPUT_FORMAT
+#define BENCHMARK_OUTPUT_FORMAT BENCHMARK_OUTPUT_CSV
+#endif
+// priority of the measuring task; the task woken by the context switch
+// benchmark runs one level above it
+#define BENCHMARK_PRIORITY (configMAX_PRIORITIES - 3)
+
+// ===== End of configuration parameters =====
+
+// create the benchmark task (on core 0 on target) instead of the application
+// tasks; once the report is printed it calls `done` if not NULL, then deletes
+// itself. Call before starting the scheduler.
+void createBenchmarkTask(void (*done)(void));
+
+#endif // BENCHMARK_H
@@ -2,6 +2,7 @@
 #define DELAY_H
 
 // function that keeps the task busy waiting for approximately `time_in_ms` milliseconds
+// (calibrated by workloadCalibrate(), see workload.h for microsecond lengths)
 void busyDelay(int time_in_ms);
 
-#endif // DELAY_H
\ No newline at end of file
+#endif // DELAY_H
@@ -1,7 +1,22 @@
 #ifndef HIGH_PRIOTASK_H
 #define HIGH_PRIOTASK_H
 
-// function to create and add a high priority task
+// Background load that used to run as a busy-waiting task at priority 20,
+// blocking every periodic task for its whole length: it is now submitted to the
+// aperiodic server (aperiodicServer.h) as synthetic load, and only runs within
+// the server's budget.
+
+// ========= Configuration parameters ========
+
+// length of each burst of load, in milliseconds
+#define HIGH_PRIO_LOAD_MS 100
+// a burst is submitted with this period, the first one after HIGH_PRIO_LOAD_MS
+#define HIGH_PRIO_PERIOD_MS 700
+
+// ===== End of configuration parameters =====
+
+// start submitting the load; needs createAperiodicServer(), call before starting
+// the scheduler
 void addHighPriorityTask();
 
-#endif // HIGH_PRIOTASK_H
\ No newline at end of file
+#endif // HIGH_PRIOTASK_H
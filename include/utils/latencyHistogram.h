@@ -0,0 +1,48 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Log-bucketed histogram of durations in microseconds. Every power of two is
+// split in LATENCY_SUB_BUCKETS buckets, so a percentile is known within
+// 1 / LATENCY_SUB_BUCKETS of its value whatever its magnitude; recording is a
+// handful of instructions and never allocates.
+
+// ========= Configuration parameters ========
+
+// 2^LATENCY_SUB_BUCKET_BITS buckets per power of two (3: within 12.5%)
+#define LATENCY_SUB_BUCKET_BITS 3
+// durations from 2^LATENCY_MAX_BITS us (about 1 s) on share one overflow bucket
+#define LATENCY_MAX_BITS 20
+
+// ===== End of configuration parameters =====
+
+#define LATENCY_SUB_BUCKETS (1u << LATENCY_SUB_BUCKET_BITS)
+// the last one is the overflow bucket
+#define LATENCY_BUCKETS ((LATENCY_MAX_BITS - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKETS + 1)
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t buckets[LATENCY_BUCKETS];
+} LatencyHistogram;
+
+void latencyHistogramInit(LatencyHistogram *histogram);
+// constant time
+void latencyHistogramRecord(LatencyHistogram *histogram, uint32_t us);
+// smallest bucket bound below which `permille` thousandths of the durations lie
+// (500: median, 990: p99, 999: p99.9), never above the maximum; 0 when empty
+uint32_t latencyHistogramPercentile(const LatencyHistogram *histogram, uint32_t permille);
+uint32_t latencyHistogramMean(const LatencyHistogram *histogram);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,157 @@
+#ifndef PERIODIC_TASK_H
+#define PERIODIC_TASK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils/taskSet.h"
+#include "utils/latencyHistogram.h"
+
+#define PERIODIC_SCHED_FIXED_PRIORITY 0
+#define PERIODIC_SCHED_EDF 1
+
+#define PERIODIC_PLACEMENT_GLOBAL 0
+#define PERIODIC_PLACEMENT_PARTITIONED 1
+
+#define PERIODIC_RELEASE_TICK 0
+#define PERIODIC_RELEASE_ALARM 1
+
+// ========= Configuration parameters ========
+
+// how the periodic tasks are scheduled:
+// PERIODIC_SCHED_FIXED_PRIORITY gives every task its own priority, derived with
+// PERIODIC_PRIORITY_POLICY; PERIODIC_SCHED_EDF runs all of them at
+// PERIODIC_BASE_PRIORITY and orders the ready jobs by absolute deadline through
+// the kernel tie-breaker (tiebreak.h), which schedules any task set with a
+// utilization up to 1 when the deadlines equal the periods
+#ifndef PERIODIC_SCHEDULING
+#define PERIODIC_SCHEDULING PERIODIC_SCHED_FIXED_PRIORITY
+#endif
+// how the priorities of the periodic tasks are derived from the task table
+#define PERIODIC_PRIORITY_POLICY PRIORITY_RATE_MONOTONIC
+// where the periodic tasks run on a multi-core target:
+// PERIODIC_PLACEMENT_GLOBAL lets the kernel run every task on any core;
+// PERIODIC_PLACEMENT_PARTITIONED pins each task to one core, chosen at start-up by
+// taskSetPartition() with PERIODIC_PARTITION_HEURISTIC and checked for the
+// scheduling above, so that each core schedules its own tasks as a uniprocessor
+// (needs configUSE_CORE_AFFINITY). `sched_analysis --cores` gives the same
+// assignment on the host
+#ifndef PERIODIC_PLACEMENT
+#define PERIODIC_PLACEMENT PERIODIC_PLACEMENT_GLOBAL
+#endif
+#define PERIODIC_PARTITION_HEURISTIC PARTITION_WORST_FIT_DECREASING
+// how the jobs are released: every task gets an alarm (releaseAlarm.h) that
+// notifies it at each release. PERIODIC_RELEASE_TICK counts in ticks and fires
+// from the tick hook, so the periods are whole ticks (1 ms) and the releases
+// fall on the tick; PERIODIC_RELEASE_ALARM counts in microseconds, for any
+// period down to the tens of microseconds (control loops at several kHz), and
+// measures how late each release fires (`release` in the statistics). The tick
+// releases need the tick running, so with TICKLESS_IDLE the alarms are the default
+#ifndef PERIODIC_RELEASE
+#if TICKLESS_IDLE
+#define PERIODIC_RELEASE PERIODIC_RELEASE_ALARM
+#else
+#define PERIODIC_RELEASE PERIODIC_RELEASE_TICK
+#endif
+#endif
+// deadline watchdog (1: on, 0: off): every task gets a second alarm
+// (releaseAlarm.h) due at the absolute deadline of each of its jobs. A job still
+// running then is logged at once (DEADLINE_MISSED in the trace, seen on the host
+// before the job ends) and handled by the missPolicy of its task (taskSet.h):
+// MISS_CONTINUE lets it finish, MISS_SKIP_NEXT drops the next release so that
+// the task catches up instead of pushing its lateness onto the tasks below it,
+// MISS_ABORT stops it. The same policy applies to a job running past its budget
+#ifndef PERIODIC_DEADLINE_WATCHDOG
+#define PERIODIC_DEADLINE_WATCHDOG 1
+#endif
+// execution budget of every job in percent of the wcet of its task (0: none),
+// from the kernel's run-time statistics (configGENERATE_RUN_TIME_STATS): the
+// processor time the job got, not the time since it started. Kept above 100 for
+// the interrupts and kernel work charged to the running task. Only MISS_ABORT
+// jobs are checked while they run; the others once they are over, where a job
+// switched out on the way misses from its count the time since it last
+// resumed, so their overruns are a lower bound
+#define PERIODIC_BUDGET_PERCENT 120
+// the jobs run their work in slices of this many microseconds and check for an
+// abort or an exhausted budget in between: the delay of both
+#define PERIODIC_WATCHDOG_SLICE_US 50
+// priority of the least urgent periodic task, the others are stacked above it
+#define PERIODIC_BASE_PRIORITY 1
+// EDF: the deadline key is the absolute deadline in units of
+// 2^PERIODIC_EDF_KEY_SHIFT microseconds from an epoch that moves up whenever no
+// job is pending, so the 32-bit key only runs out if the task set never idles
+// for 2^32 * 16 us (about 19 hours), which is asserted
+#define PERIODIC_EDF_KEY_SHIFT 4
+// maximum number of periodic tasks in the task table and in every mode
+#define PERIODIC_MAX_TASKS TASK_SET_SIZE
+// stack depth (in words) of each periodic task
+#define PERIODIC_TASK_STACK_SIZE 256
+// the logging task prints the statistics of every task at most this often
+// (0: never); each task takes 4 * LATENCY_BUCKETS words of statistics
+#define PERIODIC_STATS_REPORT_PERIOD_MS 10000
+
+// ===== End of configuration parameters =====
+
+// Mode changes: the firmware starts in the first mode of modeTable.c and
+// requestModeChange() switches to another one while it runs. The protocol is
+// idle-time switching without periodicity: once a change is requested no task
+// of the old mode is released again, the jobs in progress run to completion
+// (the tasks waiting for their next release leave at once), and when the last
+// of them completes, an idle instant of the task set, the new mode is released
+// all at once. The old jobs finish with less interference than the analysis of
+// the old mode allows for, and the new mode starts from the synchronous release
+// its own analysis assumes, so no deadline is missed in the change if both
+// modes are schedulable. The latency of a change is at most the longest
+// response time of the old mode (`sched_analysis --mode`) plus the switch
+// itself, which sets priorities, cores and resource ceilings worked out before
+// the scheduler started. The trace has MODE_CHANGE_REQUESTED and MODE_CHANGED
+// records (the mode as task number), the report the latencies.
+
+// Per-task job statistics, written by the task itself at the end of every job in
+// constant time. Other tasks read them without locking, a report may mix two
+// consecutive jobs.
+typedef struct {
+    uint32_t missed;
+    uint32_t met;
+    // deadline watchdog: jobs stopped by MISS_ABORT, releases dropped by
+    // MISS_SKIP_NEXT, jobs that ran past their budget
+    uint32_t aborted;
+    uint32_t skipped;
+    uint32_t overruns;
+    // completion - release
+    LatencyHistogram response;
+    // start - release: how long the job waited for the CPU
+    LatencyHistogram startLatency;
+    // deviation of the time between two consecutive starts from the period
+    LatencyHistogram jitter;
+    // PERIODIC_RELEASE_ALARM: alarm interrupt - release, written by the interrupt
+    LatencyHistogram release;
+} TaskStats;
+
+// Mode changes so far, written by the switches.
+typedef struct {
+    // index of the running mode in `taskModes`
+    uint32_t mode;
+    uint32_t changes;
+    // request - release of the new mode, of the last change and of all
+    uint32_t lastLatencyUs;
+    LatencyHistogram latency;
+} ModeChangeStats;
+
+// create PERIODIC_MAX_TASKS FreeRTOS tasks, which run the tasks of the first
+// mode (`taskSet`) with the generic periodic job loop, then those of every mode
+// switched to; call before starting the scheduler
+void createPeriodicTasks();
+// switch to the mode at `mode` in `taskModes`, from a task; false if there is no
+// such mode or a change is already under way
+bool requestModeChange(uint32_t mode);
+// the mode running, or starting
+const TaskMode *getCurrentMode(void);
+const ModeChangeStats *getModeChangeStats(void);
+// deadline and timing statistics of the task at `index` in the running mode,
+// since the mode started
+const TaskStats *getPeriodicTaskStats(uint32_t index);
+// print the mode change latencies and one line of statistics per task of the
+// running mode (min/mean/p50/p99/p99.9/max in us)
+void reportPeriodicTaskStats();
+
+#endif // PERIODIC_TASK_H
@@ -0,0 +1,55 @@
+#ifndef RELEASE_ALARM_H
+#define RELEASE_ALARM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils/taskSet.h"
+#include "utils/timestamp.h"
+
+// Periodic alarms at microsecond resolution, independent of the kernel tick:
+// the release mechanism of PERIODIC_RELEASE_ALARM and the deadline watchdog
+// (periodicTask.h). Each alarm
+// is due at `first`, then every `periodUs` after its previous due time, so the
+// releases never drift however late one of them fires.
+//
+// On the RP2040 they are entries of the default alarm pool (pico_time, one
+// hardware timer alarm whose interrupt goes to core 0), and also wake the
+// processor from a tickless idle. In the FreeRTOS POSIX build they are checked
+// from the tick hook and so fire at the first tick after they are due: enough
+// to test the mechanism and its accounting, not its resolution.
+//
+// Alarms on the tick (releaseAlarmStartOnTick()) count in ticks instead and
+// fire from the tick hook, at the tick they are due on: the release mechanism
+// of PERIODIC_RELEASE_TICK. They stand still while the tick does (tickless
+// idle), and a tick counted while the scheduler is suspended fires them at the
+// next one.
+
+// ========= Configuration parameters ========
+
+// alarms releaseAlarmStart() and releaseAlarmStartOnTick() take at most: the
+// release and the deadline watchdog of each periodic task
+#define RELEASE_ALARMS_MAX (2 * TASK_SET_SIZE)
+
+// ===== End of configuration parameters =====
+
+// an alarm taken by releaseAlarmStart() or releaseAlarmStartOnTick()
+typedef struct ReleaseAlarm ReleaseAlarm;
+
+// Called from the alarm interrupt, once per period: only the FromISR API of the
+// kernel may be used. `due` is when the alarm was due, `fired` when it ran.
+// Returns true if a task of higher priority than the one interrupted was woken.
+typedef bool (*ReleaseAlarmCallback)(void *arg, Timestamp due, Timestamp fired);
+
+// start an alarm calling `callback(arg)` at `first` and every `periodUs` after;
+// `first` must be in the future. Returns NULL if no alarm is left
+ReleaseAlarm *releaseAlarmStart(Timestamp first, uint32_t periodUs, ReleaseAlarmCallback callback, void *arg);
+// start an alarm calling `callback(arg)` at the tick `firstTick` and every
+// `periodTicks` after, from the tick interrupt; `due` and `fired` are both the
+// time of that tick. Returns NULL if no alarm is left
+ReleaseAlarm *releaseAlarmStartOnTick(uint32_t firstTick, uint32_t periodTicks, ReleaseAlarmCallback callback,
+                                      void *arg);
+// stop an alarm and give it back, from a task: its callback is not called
+// again once this returns, unless it is running on the other core right then
+void releaseAlarmStop(ReleaseAlarm *alarm);
+
+#endif // RELEASE_ALARM_H
@@ -0,0 +1,54 @@
+#ifndef RESOURCE_H
+#define RESOURCE_H
+
+#include <stdint.h>
+#include "utils/latencyHistogram.h"
+#include "utils/resourceSet.h"
+#include "utils/taskSet.h"
+
+// Access to the resources of resourceTable.c under the immediate priority
+// ceiling protocol: resourceAcquire() raises the calling task to the ceiling of
+// the resource, the highest priority among its users, until resourceRelease().
+// No task that could ask for the resource then runs on that core while it is
+// held, so on one core a job never waits at an acquire and is blocked at most
+// once per job, before it starts, by the longest critical section of a lower
+// task on a resource whose ceiling reaches its priority (resourceBlocking(),
+// also used by `sched_analysis`). Under EDF every ceiling is the release
+// priority of the periodic tasks: the critical sections are not preempted by
+// another periodic task.
+//
+// The resources also hold a mutex: a user running on the other core waits for
+// it, and the time every acquire waited is measured. It stays 0 for resources
+// whose users all run on one core (PERIODIC_PLACEMENT_PARTITIONED); the
+// analysis leaves the wait across cores out.
+
+// Measured use of a resource, written by its holder.
+typedef struct {
+    uint32_t acquires;
+    // critical sections longer than the `holdUs` of the table
+    uint32_t overruns;
+    // time from resourceAcquire() to holding the resource
+    LatencyHistogram wait;
+    // time the resource was held, at the ceiling
+    LatencyHistogram hold;
+} ResourceStats;
+
+// create the resources of `resourceSet` with their ceilings from the priorities
+// of the tasks of `taskSet` (`priorities[i]` for `taskSet[i]`); call before
+// starting the scheduler
+void createResources(const uint32_t *priorities);
+// recompute the ceilings for the `count` tasks of `tasks` with their
+// `priorities`: the operating mode switched to (periodicTask.h). Call only
+// while no task holds a resource
+void setResourceCeilings(const TaskDescriptor *tasks, uint32_t count, const uint32_t *priorities);
+// take the resource at `index` in `resourceSet`, raising the caller to its
+// ceiling; acquires nest, released in reverse order
+void resourceAcquire(uint32_t index);
+// release the resource at `index` and return to the priority before the acquire
+void resourceRelease(uint32_t index);
+// measured use of the resource at `index` in `resourceSet`
+const ResourceStats *getResourceStats(uint32_t index);
+// print one line per resource: ceiling, acquires, wait and hold times (us)
+void reportResourceStats(void);
+
+#endif // RESOURCE_H
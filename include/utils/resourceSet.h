@@ -0,0 +1,65 @@
+#ifndef RESOURCE_SET_H
+#define RESOURCE_SET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Description of the resources the periodic tasks share, accessed under the
+// immediate priority ceiling protocol (resource.h). Kept free of FreeRTOS so
+// that the host analysis reads the same table as the firmware and derives the
+// same blocking terms.
+
+// ========= Configuration parameters ========
+
+// number of resources in resourceTable.c, checked there at compile time
+#define RESOURCE_SET_SIZE 1
+// 1: tasks 1 and 4 share the example resource of resourceTable.c; off by
+// default, so that the task set runs and is analysed without blocking. Define it
+// for the host build as well, for its analysis to match
+#ifndef RESOURCE_EXAMPLE
+#define RESOURCE_EXAMPLE 0
+#endif
+// tasks sharing one resource at most
+#define RESOURCE_MAX_USERS 4
+
+// ===== End of configuration parameters =====
+
+typedef struct {
+    uint32_t id;
+    // longest critical section on the resource, in microseconds: the bound used
+    // by the analysis, and what every job of its users runs holding it
+    uint32_t holdUs;
+    // ids of the tasks using it, the unused entries 0
+    uint32_t users[RESOURCE_MAX_USERS];
+} ResourceDescriptor;
+
+// the resources of the application, defined in resourceTable.c
+extern const ResourceDescriptor resourceSet[];
+extern const uint32_t resourceSetSize;
+
+// whether the task `taskId` uses `resource`
+bool resourceUsedBy(const ResourceDescriptor *resource, uint32_t taskId);
+
+// Priority ceiling of `resource`: the highest of `priorities[i]` among the
+// `count` tasks `ids[i]` that use it, 0 if none of them does.
+uint32_t resourceCeiling(const ResourceDescriptor *resource, const uint32_t *ids, const uint32_t *priorities,
+                         uint32_t count);
+
+// Blocking terms under the immediate priority ceiling protocol: a job can only
+// be blocked before it starts, by one critical section of a task of lower
+// priority on a resource whose ceiling is at least its own priority.
+// `blocking[i]` receives the longest such critical section for the task `ids[i]`
+// of priority `priorities[i]`, among the `count` tasks given (those of one core:
+// the wait for a user on another core is not part of it).
+void resourceBlocking(const ResourceDescriptor *resources, uint32_t resourceCount, const uint32_t *ids,
+                      const uint32_t *priorities, uint32_t count, uint32_t *blocking);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RESOURCE_SET_H
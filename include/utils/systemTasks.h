@@ -0,0 +1,34 @@
+#ifndef SYSTEM_TASKS_H
+#define SYSTEM_TASKS_H
+
+#include "utils/highPrioTask.h"
+#include "utils/taskSet.h"
+
+// The tasks the firmware runs above the aperiodic server (aperiodicServer.h):
+// the console task of main.c and the kernel's timer service task. Their
+// interference on the server and on every task below is bounded by the costs
+// given here, with which the analysis adds them above the server
+// (`sched_analysis --server`). Kept free of FreeRTOS so that the host tools read
+// the same bounds.
+
+// ========= Configuration parameters ========
+
+// the console task looks for input this often
+#define CONSOLE_POLL_MS 50
+// execution time of one poll at most, in microseconds. While a mode change is
+// under way the console also polls every tick and prints one line, which this
+// bound leaves out
+#define CONSOLE_POLL_WCET_US 100
+// task number of the console in the analysis
+#define CONSOLE_TASK_ID 101
+// the timer service task only runs the timer of highPrioTask.c, which submits a
+// request to the server every HIGH_PRIO_PERIOD_MS; its execution time at most,
+// in microseconds
+#define TIMER_SERVICE_PERIOD_US TASK_MS(HIGH_PRIO_PERIOD_MS)
+#define TIMER_SERVICE_WCET_US 50
+// task number of the timer service task in the analysis
+#define TIMER_SERVICE_TASK_ID 102
+
+// ===== End of configuration parameters =====
+
+#endif // SYSTEM_TASKS_H
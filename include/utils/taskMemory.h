@@ -0,0 +1,65 @@
+#ifndef TASK_MEMORY_H
+#define TASK_MEMORY_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "utils/taskSet.h"
+
+// Memory of the application's tasks and kernel objects. With STATIC_ALLOCATION
+// (`cmake -DSTATIC_ALLOCATION=ON`) the kernel is built without a heap: every
+// stack, control block, queue, semaphore and timer is a static object sized at
+// compile time (the periodic tasks from TASK_SET_SIZE), so nothing can fail to
+// allocate at run time and the link-time memory map (memory_summary.py, run
+// after every firmware build) accounts for all of the RAM in use. Otherwise the
+// same objects come from the FreeRTOS heap.
+//
+// The tasks created with createTrackedTask() are listed by reportStackUsage(),
+// with how much of their stack they ever used, to size the stacks below.
+
+// ========= Configuration parameters ========
+
+// tasks createTrackedTask() keeps track of at most: the periodic tasks, the
+// logging task, the aperiodic server, the console and the two benchmark tasks
+#define TRACKED_TASKS_MAX (TASK_SET_SIZE + 5)
+// the logging task prints the stack usage at most this often (0: never)
+#define STACK_REPORT_PERIOD_MS 30000
+
+// ===== End of configuration parameters =====
+
+#ifndef STATIC_ALLOCATION
+#define STATIC_ALLOCATION 0
+#endif
+
+// any core, for createTrackedTask() (tskNO_AFFINITY of the SMP kernel)
+#define TASK_ANY_CORE ((UBaseType_t)-1)
+
+#if STATIC_ALLOCATION
+// the stacks and control blocks of `count` tasks of `depth` words each
+#define STATIC_TASKS(name, count, depth)            \
+    static StackType_t name##Stacks[count][depth]; \
+    static StaticTask_t name##Tcbs[count]
+#define STATIC_TASK_STACK(name, i) (name##Stacks[i])
+#define STATIC_TASK_TCB(name, i) (&name##Tcbs[i])
+#else
+// taken from the heap at creation
+#define STATIC_TASKS(name, count, depth) typedef int name##OnHeap
+#define STATIC_TASK_STACK(name, i) NULL
+#define STATIC_TASK_TCB(name, i) NULL
+#endif
+
+// Create a task and keep track of its stack. `stack` and `tcb` are its memory
+// in the static build (STATIC_TASK_STACK() and STATIC_TASK_TCB()), ignored
+// otherwise. With core affinity the task only runs on the cores of
+// `coreMask`, TASK_ANY_CORE for all. Call before the scheduler starts or from
+// one task at a time; returns pdPASS once created.
+BaseType_t createTrackedTask(TaskFunction_t code, const char *name, uint32_t depth, void *parameters,
+                             UBaseType_t priority, UBaseType_t coreMask, StackType_t *stack, StaticTask_t *tcb,
+                             TaskHandle_t *handle);
+// forget a task about to be deleted
+void forgetTrackedTask(TaskHandle_t handle);
+// print one line per tracked task (and the timer service task): words of stack
+// used at most so far, of its depth
+void reportStackUsage(void);
+
+#endif // TASK_MEMORY_H
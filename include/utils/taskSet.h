@@ -0,0 +1,112 @@
+#ifndef TASK_SET_H
+#define TASK_SET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils/workload.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Description of a periodic task set. Kept free of FreeRTOS so that the host
+// tools (schedulability analysis, simulation) can read the same table as the
+// firmware.
+
+// ========= Configuration parameters ========
+
+// number of tasks in taskTable.c, checked there at compile time: the memory of
+// the periodic tasks is sized from it
+#define TASK_SET_SIZE 4
+// number of operating modes in modeTable.c, checked there too; each mode runs at
+// most TASK_SET_SIZE tasks
+#define TASK_MODE_COUNT 3
+
+// ===== End of configuration parameters =====
+
+// times in the table are in microseconds
+#define TASK_MS(ms) ((uint32_t)(ms) * 1000u)
+
+typedef enum {
+    // shorter period, higher priority
+    PRIORITY_RATE_MONOTONIC = 0,
+    // shorter relative deadline, higher priority
+    PRIORITY_DEADLINE_MONOTONIC,
+    // the `priority` field of every descriptor is used as is
+    PRIORITY_EXPLICIT
+} PriorityPolicy;
+
+typedef enum {
+    // every task goes to the first core (in index order) on which it passes the test
+    PARTITION_FIRST_FIT_DECREASING = 0,
+    // every task goes to the least loaded core on which it passes the test
+    PARTITION_WORST_FIT_DECREASING
+} PartitionHeuristic;
+
+// what the deadline watchdog (periodicTask.h) does with a job still running at
+// its deadline, or past its execution budget
+typedef enum {
+    // the job runs to completion, the miss is only logged
+    MISS_CONTINUE = 0,
+    // the job runs to completion, and the task drops its next release to catch up
+    MISS_SKIP_NEXT,
+    // the job is stopped where it is, before its critical sections
+    MISS_ABORT
+} MissPolicy;
+
+typedef struct {
+    uint32_t id;
+    uint32_t periodUs;
+    // relative to the release of each job
+    uint32_t deadlineUs;
+    // execution time of each job (the bound used by the analyses)
+    uint32_t wcetUs;
+    // only used with PRIORITY_EXPLICIT, higher value means higher priority
+    uint32_t priority;
+    // execution times actually run by the jobs, NULL (left out) for wcetUs each time
+    const WorkloadModel *workload;
+    // handling of the jobs that miss their deadline or overrun their budget,
+    // MISS_CONTINUE when left out
+    MissPolicy missPolicy;
+} TaskDescriptor;
+
+// the task set of the application, defined in taskTable.c
+extern const TaskDescriptor taskSet[];
+extern const uint32_t taskSetSize;
+
+// An operating mode: a task set the firmware switches to at run time (the mode
+// change protocol of periodicTask.h). A task keeps its id across the modes it
+// runs in, with the same or other parameters.
+typedef struct {
+    const char *name;
+    const TaskDescriptor *tasks;
+    uint32_t count;
+} TaskMode;
+
+// the operating modes, defined in modeTable.c; the first one is `taskSet`, the
+// mode the firmware starts in
+extern const TaskMode taskModes[];
+extern const uint32_t taskModeCount;
+
+// Fill `priorities[i]` with the priority of `tasks[i]` under `policy`. Priorities
+// are dense and start at `basePriority` for the lowest task; tasks with the same
+// period (or deadline) share a level. Returns the highest priority used.
+uint32_t taskSetAssignPriorities(const TaskDescriptor *tasks, uint32_t count, PriorityPolicy policy,
+                                 uint32_t basePriority, uint32_t *priorities);
+
+// Pin every task to one of `cores` cores: the tasks are placed one by one in
+// order of decreasing utilization, each on a core where all the tasks placed so
+// far stay schedulable. With `priorities` (as from taskSetAssignPriorities) the
+// test is fixed-priority response-time analysis, a task passing if its response
+// time is within min(deadline, period), which is exact for deadlines up to the
+// period. Without (NULL) it is the EDF density test sum(C / min(D, T)) <= 1.
+// `coreOf[i]` receives the core of `tasks[i]`. Returns false if some task fit
+// nowhere; it is then put on the least loaded core.
+bool taskSetPartition(const TaskDescriptor *tasks, uint32_t count, const uint32_t *priorities,
+                      uint32_t cores, PartitionHeuristic heuristic, uint32_t *coreOf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TASK_SET_H
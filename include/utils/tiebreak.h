@@ -3,7 +3,8 @@
 #include <FreeRTOS.h>
 #include <task.h>
 
-extern void* volatile pxCurrentTCB;
-
+// Tie-breaker of the calling task: the value its ready-list item is ordered by
+// among the tasks of the same priority (the patched kernel inserts ready tasks
+// sorted by it, lowest first, and restores it whenever the task becomes ready).
 UBaseType_t uxTaskTieBreakerGet();
 void vTaskTieBreakerSet(UBaseType_t value);
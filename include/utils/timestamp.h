@@ -0,0 +1,35 @@
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+#include <stdint.h>
+
+// Time source for trace events and timing measurements: a monotonic 64-bit
+// count of microseconds. It never wraps in practice, unlike the 32-bit tick
+// count, and resolves events far below the 1 ms tick.
+typedef uint64_t Timestamp;
+
+#define TIMESTAMP_US_PER_MS 1000
+
+#ifdef HOST_BUILD
+
+#include <time.h>
+
+// microseconds since an arbitrary point in the past
+static inline Timestamp timestampNow(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (Timestamp)now.tv_sec * 1000000u + (Timestamp)now.tv_nsec / 1000u;
+}
+
+#else
+
+#include "pico/time.h"
+
+// microseconds since boot, read from the RP2040 timer
+static inline Timestamp timestampNow(void) {
+    return time_us_64();
+}
+
+#endif // HOST_BUILD
+
+#endif // TIMESTAMP_H
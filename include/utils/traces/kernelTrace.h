@@ -0,0 +1,69 @@
+#ifndef KERNEL_TRACE_H
+#define KERNEL_TRACE_H
+
+#include <stdint.h>
+
+// Kernel trace hooks: FreeRTOSConfig.h includes this header when
+// TRACE_KERNEL_EVENTS is set, and every context switch, task creation and
+// deletion, block and wake-up becomes one record in the per-core trace ring
+// (traceRing.h) of the core it happens on. A record is a timestamp and two
+// numbers, pushed without formatting and without locks; with
+// TRACE_KERNEL_EVENTS at 0 none of the hooks is defined and the kernel is
+// compiled exactly as without tracing.
+//
+// Only integer types may be used here, FreeRTOSConfig.h is included before
+// anything else of the kernel.
+
+// kernel event values, the EventType of the records (see traces.h); they do not
+// fit in the record header and are stored as extended records (traceFormat.h)
+#define TRACE_EVENT_TASK_SWITCHED_IN 8
+#define TRACE_EVENT_TASK_SWITCHED_OUT 9
+#define TRACE_EVENT_TASK_CREATED 10
+#define TRACE_EVENT_TASK_DELETED 11
+#define TRACE_EVENT_TASK_BLOCKED 12
+#define TRACE_EVENT_TASK_READY 13
+
+// Task number of the kernel records: the FreeRTOS task number. The creation hook
+// sets it to TRACE_KERNEL_TASK_BASE + the kernel's own TCB number, which is what
+// the logging, idle and timer tasks keep; the periodic tasks then replace it with
+// their id (vTaskSetTaskNumber()), so their creation record has the default one
+#define TRACE_KERNEL_TASK_BASE 1000
+
+// record a kernel event, callable from the kernel with interrupts masked or from
+// an interrupt; unlike logEvent() it never wakes up the logging task
+void traceKernelEvent(uint32_t event, uint32_t taskNum);
+
+// task number of the calling task, for the hooks outside of tasks.c
+uint32_t traceKernelCurrentTaskNumber(void);
+
+// the hooks themselves, only when enabled: FreeRTOS.h defines them empty otherwise
+#if TRACE_KERNEL_EVENTS
+
+// expanded inside tasks.c only, where the TCB fields are visible
+#define traceKernelTask(event, pxTCB) traceKernelEvent((event), (uint32_t)(pxTCB)->uxTaskNumber)
+
+#define traceTASK_SWITCHED_IN() traceKernelTask(TRACE_EVENT_TASK_SWITCHED_IN, pxCurrentTCB)
+#define traceTASK_SWITCHED_OUT() traceKernelTask(TRACE_EVENT_TASK_SWITCHED_OUT, pxCurrentTCB)
+#define traceTASK_CREATE(pxNewTCB)                                                 \
+    do {                                                                           \
+        (pxNewTCB)->uxTaskNumber = TRACE_KERNEL_TASK_BASE + (pxNewTCB)->uxTCBNumber; \
+        traceKernelTask(TRACE_EVENT_TASK_CREATED, pxNewTCB);                       \
+    } while (0)
+#define traceTASK_DELETE(pxTaskToDelete) traceKernelTask(TRACE_EVENT_TASK_DELETED, pxTaskToDelete)
+#define traceMOVED_TASK_TO_READY_STATE(pxTCB) traceKernelTask(TRACE_EVENT_TASK_READY, pxTCB)
+#define traceTASK_SUSPEND(pxTaskToSuspend) traceKernelTask(TRACE_EVENT_TASK_BLOCKED, pxTaskToSuspend)
+
+// the running task is about to block; the arguments of these hooks differ
+// between kernel versions and are not needed
+#define traceTASK_DELAY_UNTIL(...) traceKernelTask(TRACE_EVENT_TASK_BLOCKED, pxCurrentTCB)
+#define traceTASK_DELAY(...) traceKernelTask(TRACE_EVENT_TASK_BLOCKED, pxCurrentTCB)
+#define traceTASK_NOTIFY_TAKE_BLOCK(...) traceKernelTask(TRACE_EVENT_TASK_BLOCKED, pxCurrentTCB)
+#define traceTASK_NOTIFY_WAIT_BLOCK(...) traceKernelTask(TRACE_EVENT_TASK_BLOCKED, pxCurrentTCB)
+// these are expanded in queue.c, where the TCB is opaque
+#define traceBLOCKING_ON_QUEUE_RECEIVE(...) traceKernelEvent(TRACE_EVENT_TASK_BLOCKED, traceKernelCurrentTaskNumber())
+#define traceBLOCKING_ON_QUEUE_PEEK(...) traceKernelEvent(TRACE_EVENT_TASK_BLOCKED, traceKernelCurrentTaskNumber())
+#define traceBLOCKING_ON_QUEUE_SEND(...) traceKernelEvent(TRACE_EVENT_TASK_BLOCKED, traceKernelCurrentTaskNumber())
+
+#endif // TRACE_KERNEL_EVENTS
+
+#endif // KERNEL_TRACE_H
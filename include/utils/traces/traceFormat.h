@@ -0,0 +1,96 @@
+#ifndef TRACE_FORMAT_H
+#define TRACE_FORMAT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Binary trace format, shared by the firmware and the host decoder.
+//
+// Record (what the per-core rings store, 2-3 bytes for a typical event):
+//   header   1 byte   (taskNum << 2) | type, taskNum 63 means "escaped"
+//   taskNum  varint   only when escaped
+//   event    1 byte   only when type is TRACE_RECORD_EXTENDED: the event, for
+//                     event values that do not fit in the type bits
+//   delta    varint   zigzag-encoded timestamp difference (in microseconds) to
+//                     the previous record of the same core
+//
+// Frame (what goes over the link, one per core and drain):
+//   sync     2 bytes  TRACE_FRAME_SYNC0 TRACE_FRAME_SYNC1
+//   version  1 byte   TRACE_FORMAT_VERSION
+//   core     1 byte
+//   seq      2 bytes  per-core frame counter, little endian
+//   length   2 bytes  body length, little endian
+//   body              varint base timestamp followed by the records
+//   crc      2 bytes  CRC-16/CCITT-FALSE over version..body, little endian
+//
+// The base timestamp is the absolute timestamp the first delta of the frame
+// applies to, so every frame decodes on its own and a corrupted or lost frame
+// only loses its own records.
+//
+// Loss record: event TRACE_EVENT_LOST in the place of the events a full ring
+// turned away, its taskNum holds how many there were and its timestamp is the
+// one of the first of them. Counting every record as one event and every loss
+// record as taskNum events numbers the events of a core without gaps, so a loss
+// record at event number s marks events s .. s + taskNum - 1 as missing.
+
+// version 2 added the extended records, a version 1 stream is a valid version 2 one
+#define TRACE_FORMAT_VERSION 2
+#define TRACE_FRAME_SYNC0 0xA5
+#define TRACE_FRAME_SYNC1 0xC3
+
+#define TRACE_RECORD_TYPE_BITS 2
+#define TRACE_RECORD_TASK_ESCAPE 63
+// type of the records whose event follows in a byte of its own; events below it
+// are stored in the header, the others (up to 255) as extended records
+#define TRACE_RECORD_EXTENDED 3
+// event of the loss records, stored in the header like the job events
+#define TRACE_EVENT_LOST 2
+// largest encoded record: header + 32-bit task varint + event + 64-bit delta varint
+#define TRACE_RECORD_MAX_SIZE (1 + 5 + 1 + 10)
+
+// version + core + seq + length
+#define TRACE_FRAME_HEADER_SIZE 6
+#define TRACE_FRAME_OVERHEAD (2 + TRACE_FRAME_HEADER_SIZE + 2)
+// largest body a frame carries (base timestamp included)
+#define TRACE_FRAME_MAX_BODY 256
+#define TRACE_FRAME_MAX_SIZE (TRACE_FRAME_OVERHEAD + TRACE_FRAME_MAX_BODY)
+
+typedef struct {
+    uint32_t taskNum;
+    uint32_t event;
+    int64_t timestampDelta;
+} TraceRecord;
+
+typedef struct {
+    uint8_t bytes[TRACE_FRAME_MAX_SIZE];
+    uint32_t length;
+} TraceFrame;
+
+// write `value` as a LEB128 varint, returns the number of bytes written (at most 10)
+uint32_t traceVarintPut(uint8_t *out, uint64_t value);
+// read a varint from at most `length` bytes, returns the bytes consumed or 0 if truncated
+uint32_t traceVarintGet(const uint8_t *in, uint32_t length, uint64_t *value);
+
+// encode one record into `out` (TRACE_RECORD_MAX_SIZE bytes), returns its size
+uint32_t traceEncodeRecord(uint8_t *out, uint32_t taskNum, uint32_t event, int64_t timestampDelta);
+// decode one record from at most `length` bytes, returns its size or 0 if truncated or invalid
+uint32_t traceDecodeRecord(const uint8_t *in, uint32_t length, TraceRecord *record);
+
+uint16_t traceCrc16(uint16_t crc, const uint8_t *data, uint32_t length);
+
+// start a frame for `core` whose first record is relative to `baseTimestamp`
+void traceFrameBegin(TraceFrame *frame, uint8_t core, uint16_t seq, uint64_t baseTimestamp);
+// append an encoded record, returns false (and leaves the frame untouched) if it does not fit
+bool traceFrameAppend(TraceFrame *frame, const uint8_t *record, uint32_t length);
+// fill in the length and CRC, returns the number of bytes to send
+uint32_t traceFrameFinish(TraceFrame *frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TRACE_FORMAT_H
@@ -0,0 +1,74 @@
+#ifndef TRACE_PORT_H
+#define TRACE_PORT_H
+
+#include <stdint.h>
+
+// Platform glue for the trace ring buffers.
+//
+// A producer owns the ring of the core it runs on. On the RP2040 several tasks
+// share a core, so the few instructions that reserve and fill a slot run with
+// interrupts masked on the local core only: nothing can preempt or migrate the
+// writer, and the other core is never stalled. On a host build each thread
+// declares which "core" it stands for and masking is a no-op. The FreeRTOS POSIX
+// build (host/posix) has a single core whose tasks preempt each other, there the
+// writer runs in a kernel critical section.
+//
+// tracePortWrite() sends raw bytes of the binary trace output.
+
+#if defined(HOST_FREERTOS)
+
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define TRACE_NUM_CORES 1
+
+typedef uint32_t TracePortState;
+
+static inline uint32_t tracePortCoreId(void) { return 0; }
+static inline TracePortState tracePortEnterLocal(void) { taskENTER_CRITICAL(); return 0; }
+static inline void tracePortExitLocal(TracePortState state) { (void)state; taskEXIT_CRITICAL(); }
+static inline void tracePortWrite(const uint8_t *bytes, uint32_t length) { fwrite(bytes, 1, length, stdout); }
+
+#elif defined(HOST_BUILD)
+
+#include <stdio.h>
+
+// number of per-core rings on the host (mirrors configNUM_CORES on target)
+#define TRACE_NUM_CORES 2
+
+typedef uint32_t TracePortState;
+
+// declare the core the calling thread produces for (0 .. TRACE_NUM_CORES-1)
+void tracePortSetCoreId(uint32_t coreId);
+uint32_t tracePortCoreId(void);
+
+static inline TracePortState tracePortEnterLocal(void) { return 0; }
+static inline void tracePortExitLocal(TracePortState state) { (void)state; }
+static inline void tracePortWrite(const uint8_t *bytes, uint32_t length) { fwrite(bytes, 1, length, stdout); }
+
+#else
+
+#include "FreeRTOS.h"
+#include "hardware/sync.h"
+#include "pico/platform.h"
+#include "pico/stdio.h"
+
+#define TRACE_NUM_CORES configNUM_CORES
+
+typedef uint32_t TracePortState;
+
+static inline uint32_t tracePortCoreId(void) { return get_core_num(); }
+static inline TracePortState tracePortEnterLocal(void) { return save_and_disable_interrupts(); }
+static inline void tracePortExitLocal(TracePortState state) { restore_interrupts(state); }
+// raw output, the stdio CR/LF translation would corrupt the frames. The batch
+// goes to the drivers in one call, which takes the stdout mutex once: a task
+// printing meanwhile waits for one batch at most, not for the logger to be
+// scheduled again between two bytes
+static inline void tracePortWrite(const uint8_t *bytes, uint32_t length) {
+    stdio_put_string((const char *)bytes, (int)length, false, false);
+}
+
+#endif // HOST_FREERTOS / HOST_BUILD
+
+#endif // TRACE_PORT_H
@@ -0,0 +1,74 @@
+#ifndef TRACE_RING_H
+#define TRACE_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "utils/traces/traceFormat.h"
+
+// ========= Configuration parameters ========
+
+// number of bytes held by each per-core ring (must be a power of two);
+// records are delta encoded (traceFormat.h), a typical event takes 2-3 bytes.
+// The static build (STATIC_ALLOCATION) has no FreeRTOS heap, part of its RAM
+// goes to larger rings
+#ifndef TRACE_RING_SIZE
+#if STATIC_ALLOCATION
+#define TRACE_RING_SIZE 16384
+#else
+#define TRACE_RING_SIZE 2048
+#endif
+#endif
+// the ring is drained in two halves: the producer wakes the drain every time it
+// completes one, while it keeps filling the other
+#define TRACE_RING_HALF_SIZE (TRACE_RING_SIZE / 2)
+
+// ===== End of configuration parameters =====
+
+_Static_assert((TRACE_RING_SIZE & (TRACE_RING_SIZE - 1)) == 0, "TRACE_RING_SIZE must be a power of two");
+
+// Single-producer / single-consumer byte ring of encoded records. `head` and
+// `tail` are free-running byte counters, only the producer stores `head` and only
+// the consumer stores `tail`, so neither side ever needs a lock or a
+// read-modify-write instruction.
+typedef struct {
+    uint8_t bytes[TRACE_RING_SIZE];
+    _Atomic uint32_t head;
+    _Atomic uint32_t tail;
+    // number of records rejected because the ring was full
+    _Atomic uint32_t dropped;
+    // producer only: timestamp of the last stored record, the base of the next delta
+    uint64_t lastTimestamp;
+    // producer only: records rejected since the last loss record, and the
+    // timestamp of the first of them
+    uint32_t unreported;
+    uint64_t lossTimestamp;
+} TraceRing;
+
+typedef enum {
+    TRACE_RING_OK = 0,
+    // the record completed a half, the drain should be woken up
+    TRACE_RING_HALF_READY,
+    // the ring was full and the record was dropped
+    TRACE_RING_DROPPED
+} TraceRingStatus;
+
+// reset `ring` to the empty state (must not race with a producer or consumer)
+void traceRingInit(TraceRing *ring);
+
+// producer side: encode and append a record, never blocks. After a drop the next
+// record that fits goes in behind a loss record (TRACE_EVENT_LOST) accounting for
+// every record dropped since, so the stream never has a silent gap
+TraceRingStatus traceRingPush(TraceRing *ring, uint32_t taskNum, uint32_t event, uint64_t timestamp);
+
+// consumer side: number of committed bytes that have not been released yet
+uint32_t traceRingPending(TraceRing *ring);
+// consumer side: decode the record starting `offset` bytes after the oldest
+// pending byte, out of `pending` committed bytes. Its encoding is copied to
+// `encoded` (TRACE_RECORD_MAX_SIZE bytes). Returns the record size, 0 if none
+uint32_t traceRingPeek(TraceRing *ring, uint32_t offset, uint32_t pending, uint8_t *encoded, TraceRecord *record);
+// consumer side: hand the `length` oldest pending bytes back to the producer
+void traceRingRelease(TraceRing *ring, uint32_t length);
+
+#endif // TRACE_RING_H
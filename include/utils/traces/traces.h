@@ -3,27 +3,114 @@
 
 #include "FreeRTOS.h"
 #include "task.h"
-#include "semphr.h"
+#include "utils/timestamp.h"
+#include "utils/traces/traceRing.h"
+#include "utils/traces/kernelTrace.h"
 
 // ========= Configuration parameters ========
 
-// maximum number of log entries that can be saved before a log dump is required
-#define MAX_LOG_SIZE 500
-// number of log entries at which a log dump is triggered
-#define LOG_WATERMARK 450
-// periodicity with which the log is dumped if the watermark is not reached beforehand
-#define LOGGING_PERIOD_MS 30000 // 1 minute
+// the log is dumped every time one of the per-core rings fills half of its
+// TRACE_RING_SIZE entries (see traceRing.h), or at the latest with this period
+#define LOGGING_PERIOD_MS 30000 // 30 seconds
+// priority of the logging task. Below the periodic tasks (PERIODIC_BASE_PRIORITY)
+// the drain only runs in the time the task set leaves idle and never delays a
+// job; the rings then absorb what is logged while it waits
+#define LOGGING_TASK_PRIORITY tskIDLE_PRIORITY
+// stack depth (in words) of the logging task, the reports print from it
+#define LOGGING_TASK_STACK_SIZE 1024
+// most time one drain may take, in microseconds (0: no limit). Once spent the
+// drain goes on after the next tick, so a logging task given a priority above
+// the periodic tasks interferes with them at most like a periodic task with this
+// execution time and a period of one tick
+#ifndef LOGGING_DRAIN_BUDGET_US
+#define LOGGING_DRAIN_BUDGET_US 0
+#endif
+// functions setLoggerReport() takes at most
+#define LOGGING_MAX_REPORTS 6
+// the records are formatted or encoded into a buffer of this many bytes, handed
+// to the output in one write whenever it is full and at the end of each drain
+#define LOGGING_BATCH_SIZE 1024
+
+// format of the log dumps: TRACE_OUTPUT_BINARY sends the delta-encoded records
+// in CRC-checked frames (see traceFormat.h), to be turned back into CSV on the
+// host with `trace2csv`; TRACE_OUTPUT_CSV prints one `task,event,timestamp` line
+// per event between dump markers.
+//
+// Logging is continuous: the drain empties the rings while the tasks keep
+// logging, nothing is ever reset. What the link cannot keep up with is lost at
+// the producer and reported in the stream by a loss record (traceFormat.h).
+// The sustained rate is set by the output: a binary event takes about 3 bytes
+// (2-3 bytes of record, 10 bytes of framing per 256), a CSV line 12-20 bytes, so
+// a link moving B bytes/s carries about B / 3 events/s in binary and B / 16 in
+// CSV. getLoggerStats() gives the rate actually reached (records over the
+// uptime) and the losses. The rings themselves take over 25 M events/s on a
+// desktop host (ring_stress), far above any link
+#define TRACE_OUTPUT_CSV 0
+#define TRACE_OUTPUT_BINARY 1
+#ifndef TRACE_OUTPUT_FORMAT
+#define TRACE_OUTPUT_FORMAT TRACE_OUTPUT_BINARY
+#endif
 
 // ===== End of configuration parameters =====
 
 typedef enum {
     JOB_START = 1,
-    JOB_COMPLETION = 0
+    JOB_COMPLETION = 0,
+    // loss record: the ring was full, the task number is the count of events lost
+    EVENTS_LOST = TRACE_EVENT_LOST,
+    // recorded by the kernel trace hooks (kernelTrace.h, TRACE_KERNEL_EVENTS)
+    TASK_SWITCHED_IN = TRACE_EVENT_TASK_SWITCHED_IN,
+    TASK_SWITCHED_OUT = TRACE_EVENT_TASK_SWITCHED_OUT,
+    TASK_CREATED = TRACE_EVENT_TASK_CREATED,
+    TASK_DELETED = TRACE_EVENT_TASK_DELETED,
+    TASK_BLOCKED = TRACE_EVENT_TASK_BLOCKED,
+    TASK_READY = TRACE_EVENT_TASK_READY,
+    // recorded by the deadline watchdog (periodicTask.h): a job still running at
+    // its deadline, logged by the deadline alarm at that moment
+    DEADLINE_MISSED = 14,
+    // a release dropped by MISS_SKIP_NEXT, in the place of the job's start and completion
+    JOB_SKIPPED = 15,
+    // a job stopped by MISS_ABORT, in the place of its completion
+    JOB_ABORTED = 16,
+    // mode changes (periodicTask.h), the task number is the mode: requested, and
+    // the new mode released
+    MODE_CHANGE_REQUESTED = 17,
+    MODE_CHANGED = 18
 } EventType;
 
+// Cost of the logging task so far. The times are wall-clock, from the start to
+// the end of each drain: below the periodic tasks they include the time it was
+// preempted, above them they are exactly its interference with the task set.
+typedef struct {
+    uint32_t drains;
+    uint32_t records;
+    // handed to the output
+    uint32_t bytes;
+    uint64_t busyUs;
+    uint32_t maxDrainUs;
+    // drains stopped by LOGGING_DRAIN_BUDGET_US with records left
+    uint32_t budgetExhausted;
+    // records lost to a full ring, all cores
+    uint32_t dropped;
+} LoggerStats;
+
 // start the logger
 void initLogger();
-// log an event of type `event` that happened at time `timestamp` for task `taskNum`
-void logEvent(uint32_t taskNum, EventType event, uint32_t timestamp);
+// wake up the logging task to dump the rings now, without budget and above
+// every other task (it preempts the caller)
+void flushLogger();
+// copy the cost of the logging task so far into `stats`
+void getLoggerStats(LoggerStats *stats);
+// print the cost of the logging task on one line; done after every report of
+// setLoggerReport()
+void reportLoggerStats();
+// have the logging task call `report` after a dump, at most every `periodMs`;
+// up to LOGGING_MAX_REPORTS functions, each with its own period (setting a
+// function again changes its period)
+void setLoggerReport(void (*report)(void), uint32_t periodMs);
+// log an event of type `event` that happened at time `timestamp` (timestampNow()) for task `taskNum`
+// never blocks: the event goes to the ring of the calling core, or is counted as dropped and
+// reported by a loss record in its place
+void logEvent(uint32_t taskNum, EventType event, Timestamp timestamp);
 
-#endif // TRACES_H
\ No newline at end of file
+#endif // TRACES_H
@@ -0,0 +1,75 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Synthetic CPU load with microsecond granularity. The speed of a work loop is
+// measured once against timestampNow() (workloadCalibrate()), then a job of a
+// given length executes the matching number of loop iterations: it consumes CPU
+// time, so a preempted job still runs for its whole length once resumed.
+
+// ========= Configuration parameters ========
+
+// each calibration measurement lasts at least this long
+#define WORKLOAD_CALIBRATION_US 2000
+// number of measurements, the fastest one is kept (the others were interrupted)
+#define WORKLOAD_CALIBRATION_ROUNDS 5
+// loop iterations per millisecond until workloadCalibrate() has run (the count
+// busyDelay() was tuned with by hand, RP2040 at 125 MHz)
+#define WORKLOAD_DEFAULT_LOOPS_PER_MS 5944
+
+// ===== End of configuration parameters =====
+
+typedef enum {
+    // every job runs for the wcetUs of its task
+    WORKLOAD_WCET = 0,
+    // uniformly distributed in [minUs, maxUs]
+    WORKLOAD_UNIFORM,
+    // the `count` lengths of `trace`, in order and over again
+    WORKLOAD_TRACE
+} WorkloadKind;
+
+// execution time distribution of the jobs of a task; values above the wcetUs of
+// the task are allowed, to provoke overruns
+typedef struct WorkloadModel {
+    WorkloadKind kind;
+    uint32_t minUs;
+    uint32_t maxUs;
+    const uint32_t *trace;
+    uint32_t count;
+} WorkloadModel;
+
+// the execution times drawn for one task
+typedef struct {
+    const WorkloadModel *model;
+    uint32_t wcetUs;
+    uint32_t random;
+    uint32_t next;
+} WorkloadSequence;
+
+// measure the speed of the work loop; call once at startup, before the scheduler
+// runs, so that nothing competes with the measurement
+void workloadCalibrate(void);
+// loop iterations per millisecond in use
+uint32_t workloadLoopsPerMs(void);
+// keep the CPU busy for `us` microseconds of execution, scaled
+void workloadRun(uint32_t us);
+// stretch every workloadRun() to `percent` of its length (100 by default), to
+// find how much execution time a task set can take (see host/tools/sched_sweep.cpp)
+void workloadSetScale(uint32_t percent);
+
+// start the execution times of `model` (NULL: wcetUs for every job), `seed`
+// makes the uniform draws of the tasks differ
+void workloadSequenceInit(WorkloadSequence *sequence, const WorkloadModel *model, uint32_t wcetUs, uint32_t seed);
+// execution time of the next job, in microseconds
+uint32_t workloadSequenceNext(WorkloadSequence *sequence);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WORKLOAD_H
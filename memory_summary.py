@@ -0,0 +1,84 @@
+# Summary of the RAM taken by the statically allocated objects of the firmware,
+# run by the build after every link (see CMakeLists.txt). The linker's
+# --print-memory-usage gives the use of each memory region; this lists what fills
+# it, grouped by kind, then the largest objects. With the STATIC_ALLOCATION build
+# every stack and kernel object is in the list; otherwise they are inside the
+# FreeRTOS heap (ucHeap).
+#
+#   python3 memory_summary.py [--nm arm-none-eabi-nm] [--top N] assignment1.elf
+
+import re
+import sys
+import subprocess
+
+nm = 'arm-none-eabi-nm'
+top = 15
+
+# first matching group of a symbol, by part of its name
+groups = [
+    ('FreeRTOS heap', ('ucHeap',)),
+    ('task stacks', ('Stack',)),
+    ('task control blocks', ('Tcb',)),
+    ('trace rings and logger', ('traceRings', 'batch', 'loggerStats')),
+    ('task statistics', ('taskStats', 'serverStats')),
+]
+
+
+def group_of(name):
+    for group, parts in groups:
+        if any(part in name for part in parts):
+            return group
+    # the kernel's own variables, named in its Hungarian notation
+    if re.match(r'(px|ux|x|ul|uc|pc)[A-Z]', name):
+        return 'kernel'
+    return 'other'
+
+
+def ram_symbols(elf):
+    # `address size type name` for every sized symbol; data and bss are in RAM
+    output = subprocess.run([nm, '--print-size', '--size-sort', elf], check=True,
+                            capture_output=True, text=True).stdout
+    symbols = []
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == 4 and fields[2] in 'bBdD':
+            symbols.append((int(fields[1], 16), fields[3]))
+    return symbols
+
+
+def main(argv):
+    global nm, top
+    elf = None
+    i = 0
+    while i < len(argv):
+        if argv[i] == '--nm' and i + 1 < len(argv):
+            nm = argv[i + 1]
+            i += 1
+        elif argv[i] == '--top' and i + 1 < len(argv):
+            top = int(argv[i + 1])
+            i += 1
+        else:
+            elf = argv[i]
+        i += 1
+    if elf is None:
+        print('usage: memory_summary.py [--nm NM] [--top N] firmware.elf', file=sys.stderr)
+        return 2
+
+    symbols = ram_symbols(elf)
+    total = sum(size for size, _ in symbols)
+    totals = {}
+    for size, name in symbols:
+        group = group_of(name)
+        totals[group] = totals.get(group, 0) + size
+
+    print('Static RAM: %d bytes in %d objects' % (total, len(symbols)))
+    for group, size in sorted(totals.items(), key=lambda item: -item[1]):
+        print('  %-24s %8d' % (group, size))
+    print('Largest objects:')
+    for size, name in sorted(symbols, reverse=True)[:top]:
+        print('  %-40s %8d' % (name, size))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
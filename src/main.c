@@ -18,136 +18,43 @@
 
 #include "utils/traces/traces.h"
 #include "utils/highPrioTask.h"
-#include "utils/delay.h"
+#include "utils/aperiodicServer.h"
+#include "utils/periodicTask.h"
+#include "utils/workload.h"
 #include "utils/tiebreak.h"
-
-// Global variables
-typedef struct {
-    uint32_t missed;
-    uint32_t met;
-} TaskStats;
-
-TaskStats task_stats[4] = { {0,0}, {0,0}, {0,0}, {0,0} };
-
-// Tasks
-void vTask1(void *pvParameters){
-    TickType_t xLastWakeTime;
-    TickType_t deadline;
-    const TickType_t absolute_deadline = pdMS_TO_TICKS(4);
-    const TickType_t job_execution_time = pdMS_TO_TICKS(1);
-    const uint32_t taskID = 1;
-    const TickType_t xFrequency = pdMS_TO_TICKS(5);
-    xLastWakeTime = xTaskGetTickCount();
-
-    for(;;){
-        // record the time at which the task started the execution of a job
-        logEvent(taskID, JOB_START, (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS));
-        // Do stuff...
-        // printf("Task 1 executing\n");
-        busyDelay(job_execution_time);
-        // Code to detect misses  
-        deadline = xLastWakeTime + absolute_deadline;      
-        if (xTaskGetTickCount() > deadline) {
-            task_stats[taskID-1].missed++;
-        } else {
-            task_stats[taskID-1].met++;
+#include "utils/benchmark.h"
+#include "utils/taskMemory.h"
+#include "utils/systemTasks.h"
+
+// stack depth (in words) of the console task, which prints
+#define CONSOLE_TASK_STACK_SIZE 512
+
+STATIC_TASKS(console, 1, CONSOLE_TASK_STACK_SIZE);
+
+// Once the scheduler runs, a digit switches to that mode of modeTable.c. It runs
+// above the periodic tasks so that an overloaded mode can be left, for one poll
+// of the input every CONSOLE_POLL_MS.
+static void vConsoleTask(void *pvParameters) {
+    (void)pvParameters;
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(CONSOLE_POLL_MS));
+        int input = getchar_timeout_us(0);
+        if (input < '0' || input > '9') {
+            continue;
         }
-        // record the time at which the task completed the execution of a job
-        logEvent(taskID, JOB_COMPLETION, (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS));
-        xTaskDelayUntil(&xLastWakeTime, xFrequency);
-    }
-    // should never reach here
-    vTaskDelete(NULL);
-}
-
-void vTask2(void *pvParameters){
-    TickType_t xLastWakeTime;
-    TickType_t deadline;
-    const TickType_t absolute_deadline = pdMS_TO_TICKS(8);
-    const TickType_t job_execution_time = pdMS_TO_TICKS(2);
-    const uint32_t taskID = 2;
-    const TickType_t xFrequency = pdMS_TO_TICKS(10);
-    xLastWakeTime = xTaskGetTickCount();
-
-    for(;;){
-        // record the time at which the task started the execution of a job
-        logEvent(taskID, JOB_START, (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS));
-        // Do stuff...
-        // printf("Task 2 executing\n");
-        busyDelay(job_execution_time);
-        // Code to detect misses  
-        deadline = xLastWakeTime + absolute_deadline;      
-        if (xTaskGetTickCount() > deadline) {
-            task_stats[taskID-1].missed++;
-        } else {
-            task_stats[taskID-1].met++;
+        uint32_t mode = (uint32_t)(input - '0');
+        uint32_t changes = getModeChangeStats()->changes;
+        if (!requestModeChange(mode)) {
+            printf("No mode %u, or a mode change is under way\n", (unsigned)mode);
+            continue;
         }
-        // record the time at which the task completed the execution of a job
-        logEvent(taskID, JOB_COMPLETION, (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS));
-        xTaskDelayUntil(&xLastWakeTime, xFrequency);
-    }
-    // should never reach here
-    vTaskDelete(NULL);
-}
-
-void vTask3(void *pvParameters){
-    TickType_t xLastWakeTime;
-    TickType_t deadline;
-    const TickType_t absolute_deadline = pdMS_TO_TICKS(15);
-    const TickType_t job_execution_time = pdMS_TO_TICKS(3);
-    const uint32_t taskID = 3;
-    const TickType_t xFrequency = pdMS_TO_TICKS(15);
-    xLastWakeTime = xTaskGetTickCount();
-
-    for(;;){
-        // record the time at which the task started the execution of a job
-        logEvent(taskID, JOB_START, (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS));
-        // Do stuff...
-        // printf("Task 3 executing\n");
-        busyDelay(job_execution_time);
-        // Code to detect misses  
-        deadline = xLastWakeTime + absolute_deadline;      
-        if (xTaskGetTickCount() > deadline) {
-            task_stats[taskID-1].missed++;
-        } else {
-            task_stats[taskID-1].met++;
-        }
-        // record the time at which the task completed the execution of a job
-        logEvent(taskID, JOB_COMPLETION, (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS));
-        xTaskDelayUntil(&xLastWakeTime, xFrequency);
-    }
-    // should never reach here
-    vTaskDelete(NULL);
-}
-
-void vTask4(void *pvParameters){
-    TickType_t xLastWakeTime;
-    TickType_t deadline;
-    const TickType_t absolute_deadline = pdMS_TO_TICKS(14);
-    const TickType_t job_execution_time = pdMS_TO_TICKS(6);
-    const uint32_t taskID = 4;
-    const TickType_t xFrequency = pdMS_TO_TICKS(30);
-    xLastWakeTime = xTaskGetTickCount();
-
-    for(;;){
-        // record the time at which the task started the execution of a job
-        logEvent(taskID, JOB_START, (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS));
-        // Do stuff...
-        // printf("Task 4 executing\n");
-        busyDelay(job_execution_time);
-        // Code to detect misses  
-        deadline = xLastWakeTime + absolute_deadline;      
-        if (xTaskGetTickCount() > deadline) {
-            task_stats[taskID-1].missed++;
-        } else {
-            task_stats[taskID-1].met++;
+        // the change takes at most the longest response time of the old mode
+        while (getModeChangeStats()->changes == changes) {
+            vTaskDelay(1);
         }
-        // record the time at which the task completed the execution of a job
-        logEvent(taskID, JOB_COMPLETION, (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS));
-        xTaskDelayUntil(&xLastWakeTime, xFrequency);
+        printf("Mode %s started %u us after the request\n", taskModes[mode].name,
+               (unsigned)getModeChangeStats()->lastLatencyUs);
     }
-    // should never reach here
-    vTaskDelete(NULL);
 }
 
 int main() {
@@ -163,7 +70,12 @@ int main() {
         return -1;
     }   
 
-    printf("Menu:\ns -> start the scheduler\nq -> quit\n");
+    printf("Menu:\ns -> start the scheduler\nb -> run the microbenchmarks\nq -> quit\n");
+    printf("Once started:\n");
+    for (uint32_t mode = 0; mode < taskModeCount; mode++) {
+        printf("%u -> switch to mode %s (%u tasks)\n", (unsigned)mode, taskModes[mode].name,
+               (unsigned)taskModes[mode].count);
+    }
 
     int input_char;
 
@@ -173,21 +85,38 @@ int main() {
             case 's':
                 // turn off the LED before starting the scheduler
                 // cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, 0);
+                // measure the speed of the synthetic workload while nothing else runs
+                workloadCalibrate();
+                printf("Workload calibrated: %u loops/ms\n", (unsigned)workloadLoopsPerMs());
                 // initialize the logger and start the logging task
                 initLogger();
-                // start a high priority task running at priority 20
+                // aperiodic and background work runs through the server, within its budget
+                createAperiodicServer();
+                // submit the 100 ms of load every 700 ms to the server
                 // addHighPriorityTask();
                 
-                // create task 1-4
-                xTaskCreate(vTask1, "Task 1", 256, NULL, 4, NULL);
-                xTaskCreate(vTask2, "Task 2", 256, NULL, 3, NULL);
-                xTaskCreate(vTask3, "Task 3", 256, NULL, 2, NULL);
-                xTaskCreate(vTask4, "Task 4", 256, NULL, 1, NULL);
+                // create the periodic tasks described in taskTable.c, and modeTable.c
+                createPeriodicTasks();
+                if (createTrackedTask(vConsoleTask, "Console", CONSOLE_TASK_STACK_SIZE, NULL,
+                                      configMAX_PRIORITIES - 2, TASK_ANY_CORE, STATIC_TASK_STACK(console, 0),
+                                      STATIC_TASK_TCB(console, 0), NULL) != pdPASS) {
+                    printf("Failed to create the console task!\n");
+                }
+#if STACK_REPORT_PERIOD_MS > 0
+                // how much of its stack every task used, to size them
+                setLoggerReport(reportStackUsage, STACK_REPORT_PERIOD_MS);
+#endif
                 
                 // start the scheduler
                 printf("Scheduler started\n");
                 vTaskStartScheduler();
                 break;
+            case 'b':
+                // measure the tracing and kernel primitives, no application tasks
+                createBenchmarkTask(NULL);
+                printf("Benchmark started\n");
+                vTaskStartScheduler();
+                break;
             case 'q':
                 printf("Program stopped\n");
                 cyw43_arch_deinit();
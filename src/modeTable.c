@@ -0,0 +1,39 @@
+#include "utils/taskSet.h"
+#include <stddef.h>
+
+// The operating modes the firmware switches between at run time (see the mode
+// change protocol in periodicTask.h), each a task table like taskTable.c. A mode
+// adds tasks (a new id), removes them (an id left out) or gives them other
+// parameters (the same id); ids and priorities follow the same rules as in
+// taskTable.c. Every mode has at most TASK_SET_SIZE tasks, and TASK_MODE_COUNT
+// in taskSet.h is the number of entries of `taskModes`.
+
+// tasks 3 and 4 stopped, the control loops of tasks 1 and 2 kept
+static const TaskDescriptor degradedTasks[] = {
+    //  id  period       deadline     wcet         priority  workload  on a miss
+    {   1,  TASK_MS(5),  TASK_MS(4),  TASK_MS(1),  4,        NULL,     MISS_CONTINUE },
+    {   2,  TASK_MS(10), TASK_MS(8),  TASK_MS(2),  3,        NULL,     MISS_CONTINUE },
+};
+
+// task 1 at twice the rate, task 4 replaced by task 5
+static const TaskDescriptor fastTasks[] = {
+    //  id  period       deadline     wcet         priority  workload  on a miss
+    {   1,  TASK_MS(2),  TASK_MS(2),  500,         4,        NULL,     MISS_CONTINUE },
+    {   2,  TASK_MS(10), TASK_MS(8),  TASK_MS(2),  3,        NULL,     MISS_CONTINUE },
+    {   3,  TASK_MS(15), TASK_MS(15), TASK_MS(3),  2,        NULL,     MISS_CONTINUE },
+    {   5,  TASK_MS(20), TASK_MS(20), TASK_MS(2),  1,        NULL,     MISS_CONTINUE },
+};
+
+#define MODE(name, tasks) { name, tasks, sizeof(tasks) / sizeof(tasks[0]) }
+
+const TaskMode taskModes[] = {
+    { "normal", taskSet, TASK_SET_SIZE },
+    MODE("degraded", degradedTasks),
+    MODE("fast", fastTasks),
+};
+
+const uint32_t taskModeCount = sizeof(taskModes) / sizeof(taskModes[0]);
+
+_Static_assert(sizeof(taskModes) / sizeof(taskModes[0]) == TASK_MODE_COUNT, "TASK_MODE_COUNT must match the table");
+_Static_assert(sizeof(degradedTasks) / sizeof(degradedTasks[0]) <= TASK_SET_SIZE, "too many tasks in a mode");
+_Static_assert(sizeof(fastTasks) / sizeof(fastTasks[0]) <= TASK_SET_SIZE, "too many tasks in a mode");
@@ -0,0 +1,21 @@
+#include "utils/resourceSet.h"
+
+// The resources shared by the periodic tasks of taskTable.c. Every job of a
+// user runs `hold` of its execution time (from the workload of its task) inside
+// a critical section on the resource, at the end of the job; the ceilings are
+// derived from the priorities of the users, so changing the sharing only means
+// editing this table (and RESOURCE_SET_SIZE in resourceSet.h).
+const ResourceDescriptor resourceSet[] = {
+    //  id  hold   users
+#if RESOURCE_EXAMPLE
+    {   1,  500,   { 1, 4 } },
+#else
+    // no users until RESOURCE_EXAMPLE is set (the table cannot be empty)
+    {   1,  500,   { 0 } },
+#endif
+};
+
+const uint32_t resourceSetSize = sizeof(resourceSet) / sizeof(resourceSet[0]);
+
+_Static_assert(sizeof(resourceSet) / sizeof(resourceSet[0]) == RESOURCE_SET_SIZE,
+               "RESOURCE_SET_SIZE must match the table");
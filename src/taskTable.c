@@ -0,0 +1,26 @@
+#include "utils/taskSet.h"
+#include <stddef.h>
+
+// The periodic task set run by the firmware. Priorities are derived from the
+// table (see PERIODIC_PRIORITY_POLICY in periodicTask.h) unless the policy is
+// PRIORITY_EXPLICIT, so changing the workload only means editing this table
+// (and TASK_SET_SIZE in taskSet.h with the number of rows).
+// Jobs run for their wcet unless the workload column points at a WorkloadModel
+// (workload.h), e.g. to draw the execution times of task 3 from [1 ms, 3 ms]:
+//
+//   static const WorkloadModel task3Load = { WORKLOAD_UNIFORM, TASK_MS(1), TASK_MS(3), NULL, 0 };
+//   {   3,  TASK_MS(15), TASK_MS(15), TASK_MS(3),  2, &task3Load },
+//
+// The last column is what happens to a job that misses its deadline or overruns
+// its budget (MissPolicy in taskSet.h, the deadline watchdog in periodicTask.h).
+const TaskDescriptor taskSet[] = {
+    //  id  period       deadline     wcet         priority  workload  on a miss
+    {   1,  TASK_MS(5),  TASK_MS(4),  TASK_MS(1),  4,        NULL,     MISS_CONTINUE },
+    {   2,  TASK_MS(10), TASK_MS(8),  TASK_MS(2),  3,        NULL,     MISS_CONTINUE },
+    {   3,  TASK_MS(15), TASK_MS(15), TASK_MS(3),  2,        NULL,     MISS_CONTINUE },
+    {   4,  TASK_MS(30), TASK_MS(14), TASK_MS(6),  1,        NULL,     MISS_CONTINUE },
+};
+
+const uint32_t taskSetSize = sizeof(taskSet) / sizeof(taskSet[0]);
+
+_Static_assert(sizeof(taskSet) / sizeof(taskSet[0]) == TASK_SET_SIZE, "TASK_SET_SIZE must match the table");
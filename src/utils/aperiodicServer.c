@@ -0,0 +1,284 @@
+#include "utils/aperiodicServer.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "utils/periodicTask.h"
+#include "utils/taskMemory.h"
+#include "utils/timestamp.h"
+#include "utils/traces/traces.h"
+#include "utils/workload.h"
+#include <stdio.h>
+#include <string.h>
+
+#define US_PER_TICK (portTICK_PERIOD_MS * TIMESTAMP_US_PER_MS)
+
+typedef struct {
+    // NULL: `costUs` of synthetic load
+    AperiodicHandler handler;
+    void *arg;
+    uint32_t costUs;
+    Timestamp submitted;
+} AperiodicRequest;
+
+// sporadic: `amount` of budget coming back at `at`
+typedef struct {
+    Timestamp at;
+    uint32_t amount;
+} Replenishment;
+
+static QueueHandle_t requestQueue = NULL;
+#if STATIC_ALLOCATION
+static uint8_t requestStorage[APERIODIC_QUEUE_LENGTH * sizeof(AperiodicRequest)];
+static StaticQueue_t requestQueueMemory;
+#endif
+STATIC_TASKS(server, 1, APERIODIC_SERVER_STACK_SIZE);
+// written by the server task only, except `submitted` and `rejected` which the
+// submitters update in a critical section
+static AperiodicStats serverStats;
+
+// server task state
+static uint32_t budget;
+#if APERIODIC_SERVER_POLICY == APERIODIC_SERVER_SPORADIC
+// in time order
+static Replenishment replenishments[APERIODIC_MAX_REPLENISHMENTS];
+static uint32_t replenishmentCount;
+// the server has been consuming budget since `activeSince`, `activeConsumed` of it
+static bool active;
+static Timestamp activeSince;
+static uint32_t activeConsumed;
+#else
+// the budget is refilled at the start of every period
+static Timestamp nextPeriod;
+#endif
+
+// bring the budget up to date at time `now`
+static void replenish(Timestamp now) {
+#if APERIODIC_SERVER_POLICY == APERIODIC_SERVER_SPORADIC
+    uint32_t due = 0;
+    while (due < replenishmentCount && replenishments[due].at <= now) {
+        budget += replenishments[due].amount;
+        due++;
+    }
+    if (due > 0) {
+        replenishmentCount -= due;
+        memmove(replenishments, replenishments + due, replenishmentCount * sizeof(replenishments[0]));
+    }
+#else
+    if (now >= nextPeriod) {
+        budget = APERIODIC_SERVER_BUDGET_US;
+        // the periods that went by unused are skipped
+        nextPeriod += ((now - nextPeriod) / APERIODIC_SERVER_PERIOD_US + 1) * APERIODIC_SERVER_PERIOD_US;
+    }
+#endif
+}
+
+// the server stops consuming: idle, or out of budget
+static void deactivate(void) {
+#if APERIODIC_SERVER_POLICY == APERIODIC_SERVER_SPORADIC
+    if (!active) {
+        return;
+    }
+    active = false;
+    if (activeConsumed == 0) {
+        return;
+    }
+    // what was consumed since the activation comes back one period after it
+    Timestamp at = activeSince + APERIODIC_SERVER_PERIOD_US;
+    if (replenishmentCount < APERIODIC_MAX_REPLENISHMENTS) {
+        replenishments[replenishmentCount].at = at;
+        replenishments[replenishmentCount].amount = activeConsumed;
+        replenishmentCount++;
+    } else {
+        // later than planned for the last one, which only holds budget back
+        replenishments[replenishmentCount - 1].at = at;
+        replenishments[replenishmentCount - 1].amount += activeConsumed;
+    }
+#endif
+}
+
+// take `us` of execution that started at `start` off the budget
+static void charge(Timestamp start, uint32_t us) {
+    uint32_t taken = us < budget ? us : budget;
+    budget -= taken;
+    serverStats.busyUs += us;
+#if APERIODIC_SERVER_POLICY == APERIODIC_SERVER_SPORADIC
+    if (!active) {
+        active = true;
+        activeSince = start;
+        activeConsumed = 0;
+    }
+    activeConsumed += taken;
+#else
+    (void)start;
+#endif
+}
+
+// sleep until the budget grows again; whole ticks, the caller checks again on return
+static void waitForBudget(void) {
+    deactivate();
+    serverStats.budgetExhausted++;
+#if APERIODIC_SERVER_POLICY == APERIODIC_SERVER_SPORADIC
+    // never empty here: everything consumed is scheduled back by deactivate()
+    Timestamp at = replenishments[0].at;
+#else
+    Timestamp at = nextPeriod;
+#endif
+    Timestamp now = timestampNow();
+    vTaskDelay(at > now ? (TickType_t)((at - now + US_PER_TICK - 1) / US_PER_TICK) : 1);
+}
+
+static void serve(const AperiodicRequest *request) {
+    uint32_t left = request->costUs;
+    Timestamp end = 0;
+    for (;;) {
+        replenish(timestampNow());
+        // a handler runs in one go, synthetic load in pieces
+        if (budget == 0 || (request->handler != NULL && budget < request->costUs)) {
+            waitForBudget();
+            continue;
+        }
+        uint32_t piece = left < budget ? left : budget;
+        Timestamp start = timestampNow();
+        logEvent(APERIODIC_SERVER_TASK_ID, JOB_START, start);
+        if (request->handler != NULL) {
+            request->handler(request->arg);
+        } else {
+            workloadRun(piece);
+        }
+        end = timestampNow();
+        logEvent(APERIODIC_SERVER_TASK_ID, JOB_COMPLETION, end);
+        uint32_t elapsed = end - start > UINT32_MAX ? UINT32_MAX : (uint32_t)(end - start);
+        charge(start, elapsed);
+        if (request->handler != NULL) {
+            if (elapsed > request->costUs) {
+                serverStats.overruns++;
+            }
+            break;
+        }
+        left -= piece;
+        if (left == 0) {
+            break;
+        }
+    }
+    serverStats.served++;
+    uint64_t response = end - request->submitted;
+    latencyHistogramRecord(&serverStats.response, response > UINT32_MAX ? UINT32_MAX : (uint32_t)response);
+}
+
+static void vAperiodicServer(void *pvParameters) {
+    (void)pvParameters;
+    AperiodicRequest request;
+    budget = APERIODIC_SERVER_BUDGET_US;
+#if APERIODIC_SERVER_POLICY != APERIODIC_SERVER_SPORADIC
+    nextPeriod = timestampNow() + APERIODIC_SERVER_PERIOD_US;
+#endif
+    for (;;) {
+#if APERIODIC_SERVER_POLICY == APERIODIC_SERVER_POLLING
+        // poll once per period: an empty queue gives the rest of the budget up
+        replenish(timestampNow());
+        if (budget == 0 || xQueueReceive(requestQueue, &request, 0) != pdPASS) {
+            budget = 0;
+            Timestamp now = timestampNow();
+            vTaskDelay(nextPeriod > now ? (TickType_t)((nextPeriod - now + US_PER_TICK - 1) / US_PER_TICK) : 1);
+            continue;
+        }
+#else
+        if (uxQueueMessagesWaiting(requestQueue) == 0) {
+            deactivate();
+        }
+        xQueueReceive(requestQueue, &request, portMAX_DELAY);
+#endif
+        serve(&request);
+    }
+    vTaskDelete(NULL);
+}
+
+// a request the server could never start is refused up front
+static bool admissible(AperiodicHandler handler, uint32_t costUs) {
+    return costUs > 0 && (handler == NULL || costUs <= APERIODIC_SERVER_BUDGET_US);
+}
+
+bool aperiodicSubmit(AperiodicHandler handler, void *arg, uint32_t costUs) {
+    AperiodicRequest request = { handler, arg, costUs, timestampNow() };
+    bool queued = requestQueue != NULL && admissible(handler, costUs) &&
+                  xQueueSendToBack(requestQueue, &request, 0) == pdPASS;
+    taskENTER_CRITICAL();
+    serverStats.submitted++;
+    if (!queued) {
+        serverStats.rejected++;
+    }
+    taskEXIT_CRITICAL();
+    return queued;
+}
+
+bool aperiodicSubmitFromISR(AperiodicHandler handler, void *arg, uint32_t costUs, bool *yield) {
+    AperiodicRequest request = { handler, arg, costUs, timestampNow() };
+    BaseType_t woken = pdFALSE;
+    bool queued = requestQueue != NULL && admissible(handler, costUs) &&
+                  xQueueSendToBackFromISR(requestQueue, &request, &woken) == pdPASS;
+    UBaseType_t state = taskENTER_CRITICAL_FROM_ISR();
+    serverStats.submitted++;
+    if (!queued) {
+        serverStats.rejected++;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(state);
+    *yield = woken == pdTRUE;
+    return queued;
+}
+
+void createAperiodicServer(void) {
+    configASSERT(APERIODIC_SERVER_BUDGET_US > 0 && APERIODIC_SERVER_BUDGET_US <= APERIODIC_SERVER_PERIOD_US);
+    configASSERT(APERIODIC_SERVER_PRIORITY < configMAX_PRIORITIES);
+    latencyHistogramInit(&serverStats.response);
+#if STATIC_ALLOCATION
+    requestQueue = xQueueCreateStatic(APERIODIC_QUEUE_LENGTH, sizeof(AperiodicRequest), requestStorage,
+                                      &requestQueueMemory);
+#else
+    requestQueue = xQueueCreate(APERIODIC_QUEUE_LENGTH, sizeof(AperiodicRequest));
+#endif
+    if (requestQueue == NULL) {
+        printf("Failed to create the aperiodic request queue!\n");
+        return;
+    }
+#if PERIODIC_STATS_REPORT_PERIOD_MS > 0
+    // along with the statistics of the periodic tasks
+    setLoggerReport(reportAperiodicStats, PERIODIC_STATS_REPORT_PERIOD_MS);
+#endif
+    TaskHandle_t handle;
+#if PERIODIC_PLACEMENT == PERIODIC_PLACEMENT_PARTITIONED
+    UBaseType_t coreMask = (UBaseType_t)1 << APERIODIC_SERVER_CORE;
+#else
+    UBaseType_t coreMask = TASK_ANY_CORE;
+#endif
+    BaseType_t created = createTrackedTask(vAperiodicServer, "Aperiodic", APERIODIC_SERVER_STACK_SIZE, NULL,
+                                           APERIODIC_SERVER_PRIORITY, coreMask, STATIC_TASK_STACK(server, 0),
+                                           STATIC_TASK_TCB(server, 0), &handle);
+    if (created != pdPASS) {
+        printf("Failed to create the aperiodic server!\n");
+        return;
+    }
+#if configUSE_TRACE_FACILITY
+    vTaskSetTaskNumber(handle, APERIODIC_SERVER_TASK_ID);
+#endif
+}
+
+void getAperiodicStats(AperiodicStats *stats) {
+    taskENTER_CRITICAL();
+    *stats = serverStats;
+    taskEXIT_CRITICAL();
+}
+
+void reportAperiodicStats(void) {
+    static const char *const policies[] = { "polling", "deferrable", "sporadic" };
+    AperiodicStats stats;
+    getAperiodicStats(&stats);
+    const LatencyHistogram *response = &stats.response;
+    printf("aperiodic (%s server, %u us every %u us): %u submitted, %u served, %u rejected, %u overruns,"
+           " %u budget waits, busy %llu us; response min/mean/p50/p99/max %u/%u/%u/%u/%u us\n",
+           policies[APERIODIC_SERVER_POLICY], (unsigned)APERIODIC_SERVER_BUDGET_US,
+           (unsigned)APERIODIC_SERVER_PERIOD_US, (unsigned)stats.submitted, (unsigned)stats.served,
+           (unsigned)stats.rejected, (unsigned)stats.overruns, (unsigned)stats.budgetExhausted,
+           (unsigned long long)stats.busyUs, (unsigned)(response->count > 0 ? response->min : 0),
+           (unsigned)latencyHistogramMean(response), (unsigned)latencyHistogramPercentile(response, 500),
+           (unsigned)latencyHistogramPercentile(response, 990), (unsigned)response->max);
+}
@@ -0,0 +1,253 @@
+#include "utils/benchmark.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "utils/taskMemory.h"
+#include "utils/timestamp.h"
+#include "utils/traces/traces.h"
+#include "utils/traces/traceRing.h"
+#include "utils/traces/tracePort.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef HOST_BUILD
+
+#define BENCH_UNIT "ns"
+
+typedef uint64_t BenchTime;
+
+static inline BenchTime benchNow(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (BenchTime)now.tv_sec * 1000000000u + (BenchTime)now.tv_nsec;
+}
+
+static inline uint32_t benchElapsed(BenchTime start, BenchTime end) {
+    return (uint32_t)(end - start);
+}
+
+#else
+
+#include "hardware/structs/systick.h"
+
+#define BENCH_UNIT "cycles"
+
+typedef uint32_t BenchTime;
+
+// the SysTick of core 0 drives the kernel tick: it counts processor cycles down
+// from its reload value and starts over at every tick
+static inline BenchTime benchNow(void) {
+    return systick_hw->cvr;
+}
+
+// at most one reload in between, the measured paths are far shorter than a tick
+static inline uint32_t benchElapsed(BenchTime start, BenchTime end) {
+    return start >= end ? start - end : start + systick_hw->rvr + 1 - end;
+}
+
+#endif // HOST_BUILD
+
+// the rows of the report
+#define MAX_RESULTS 12
+
+typedef struct {
+    const char *name;
+    uint32_t min;
+    uint32_t median;
+    uint32_t max;
+} BenchResult;
+
+static uint32_t samples[BENCHMARK_SAMPLES];
+static BenchResult results[MAX_RESULTS];
+static uint32_t resultCount;
+static void (*doneFunction)(void);
+
+// the alternative loggers: entries written in place into an array
+typedef struct {
+    uint32_t taskNum;
+    uint32_t event;
+    Timestamp timestamp;
+} ArrayLogEntry;
+
+static ArrayLogEntry arrayLog[BENCHMARK_SAMPLES];
+static uint32_t arrayLogIndex;
+static SemaphoreHandle_t logMutex;
+// private ring for logEvent()'s push, emptied between the samples
+static TraceRing benchRing;
+
+// context switch benchmark: the measuring task notifies this one, one priority
+// level above it on the same core, which takes the sample when it runs
+static TaskHandle_t switchTaskHandle;
+#if STATIC_ALLOCATION
+static StaticSemaphore_t logMutexMemory;
+#endif
+STATIC_TASKS(benchmarkTask, 1, 1024);
+STATIC_TASKS(switchTask, 1, 256);
+static volatile BenchTime switchStart;
+static volatile uint32_t switchIndex;
+
+static int compareSamples(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+// reduce the BENCHMARK_SAMPLES samples to a row of the report
+static void addResult(const char *name) {
+    configASSERT(resultCount < MAX_RESULTS);
+    qsort(samples, BENCHMARK_SAMPLES, sizeof(samples[0]), compareSamples);
+    BenchResult *result = &results[resultCount++];
+    result->name = name;
+    result->min = samples[0];
+    result->median = samples[BENCHMARK_SAMPLES / 2];
+    result->max = samples[BENCHMARK_SAMPLES - 1];
+}
+
+// the former logger: one writer at a time, serialised by a mutex
+static void mutexLogEvent(uint32_t taskNum, EventType event, Timestamp timestamp) {
+    xSemaphoreTake(logMutex, portMAX_DELAY);
+    ArrayLogEntry *entry = &arrayLog[arrayLogIndex++ % BENCHMARK_SAMPLES];
+    entry->taskNum = taskNum;
+    entry->event = event;
+    entry->timestamp = timestamp;
+    xSemaphoreGive(logMutex);
+}
+
+static void criticalLogEvent(uint32_t taskNum, EventType event, Timestamp timestamp) {
+    taskENTER_CRITICAL();
+    ArrayLogEntry *entry = &arrayLog[arrayLogIndex++ % BENCHMARK_SAMPLES];
+    entry->taskNum = taskNum;
+    entry->event = event;
+    entry->timestamp = timestamp;
+    taskEXIT_CRITICAL();
+}
+
+// what logEvent() does, on a ring nobody else uses
+static void ringLogEvent(uint32_t taskNum, EventType event, Timestamp timestamp) {
+    TracePortState state = tracePortEnterLocal();
+    traceRingPush(&benchRing, taskNum, event, timestamp);
+    tracePortExitLocal(state);
+}
+
+static void benchLogger(const char *name, void (*log)(uint32_t, EventType, Timestamp)) {
+    for (uint32_t i = 0; i < BENCHMARK_SAMPLES; i++) {
+        // the ring never fills up, a full ring would time the cheaper drop path
+        traceRingRelease(&benchRing, traceRingPending(&benchRing));
+        Timestamp timestamp = timestampNow();
+        BenchTime start = benchNow();
+        log(1, i & 1 ? JOB_START : JOB_COMPLETION, timestamp);
+        samples[i] = benchElapsed(start, benchNow());
+    }
+    addResult(name);
+}
+
+static void vSwitchTask(void *pvParameters) {
+    (void)pvParameters;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        BenchTime end = benchNow();
+        samples[switchIndex] = benchElapsed(switchStart, end);
+    }
+}
+
+static void printReport(void) {
+#if BENCHMARK_OUTPUT_FORMAT == BENCHMARK_OUTPUT_JSON
+    printf("{\"unit\": \"%s\", \"samples\": %u, \"results\": [", BENCH_UNIT, (unsigned)BENCHMARK_SAMPLES);
+    for (uint32_t i = 0; i < resultCount; i++) {
+        printf("%s\n  {\"name\": \"%s\", \"min\": %u, \"median\": %u, \"max\": %u}", i == 0 ? "" : ",",
+               results[i].name, (unsigned)results[i].min, (unsigned)results[i].median, (unsigned)results[i].max);
+    }
+    printf("\n]}\n");
+#else
+    printf("====Benchmark start====\n");
+    printf("name,unit,samples,min,median,max\n");
+    for (uint32_t i = 0; i < resultCount; i++) {
+        printf("%s,%s,%u,%u,%u,%u\n", results[i].name, BENCH_UNIT, (unsigned)BENCHMARK_SAMPLES,
+               (unsigned)results[i].min, (unsigned)results[i].median, (unsigned)results[i].max);
+    }
+    printf("====Benchmark end====\n");
+#endif
+}
+
+static void vBenchmarkTask(void *pvParameters) {
+    (void)pvParameters;
+    resultCount = 0;
+
+    // reading the timer, part of every other sample
+    for (uint32_t i = 0; i < BENCHMARK_SAMPLES; i++) {
+        BenchTime start = benchNow();
+        samples[i] = benchElapsed(start, benchNow());
+    }
+    addResult("timer");
+
+    for (uint32_t i = 0; i < BENCHMARK_SAMPLES; i++) {
+        BenchTime start = benchNow();
+        volatile Timestamp timestamp = timestampNow();
+        samples[i] = benchElapsed(start, benchNow());
+        (void)timestamp;
+    }
+    addResult("timestampNow");
+
+    traceRingInit(&benchRing);
+    benchLogger("log ring", ringLogEvent);
+    benchLogger("log mutex", mutexLogEvent);
+    benchLogger("log critical", criticalLogEvent);
+
+    for (uint32_t i = 0; i < BENCHMARK_SAMPLES; i++) {
+        BenchTime start = benchNow();
+        xSemaphoreTake(logMutex, portMAX_DELAY);
+        xSemaphoreGive(logMutex);
+        samples[i] = benchElapsed(start, benchNow());
+    }
+    addResult("mutex take+give");
+
+    // a wake time already passed: the call returns without blocking
+    for (uint32_t i = 0; i < BENCHMARK_SAMPLES; i++) {
+        TickType_t lastWakeTime = xTaskGetTickCount() - 2;
+        BenchTime start = benchNow();
+        xTaskDelayUntil(&lastWakeTime, 1);
+        samples[i] = benchElapsed(start, benchNow());
+    }
+    addResult("xTaskDelayUntil expired");
+
+#ifndef HOST_BUILD
+    // from the tick interrupt (the SysTick reload) to the woken task running
+    for (uint32_t i = 0; i < BENCHMARK_SAMPLES; i++) {
+        vTaskDelay(1);
+        samples[i] = benchElapsed(systick_hw->rvr, benchNow());
+    }
+    addResult("tick to task");
+#endif
+
+    // xTaskNotifyGive() to a blocked task of higher priority, until it runs
+    for (uint32_t i = 0; i < BENCHMARK_SAMPLES; i++) {
+        switchIndex = i;
+        switchStart = benchNow();
+        xTaskNotifyGive(switchTaskHandle);
+    }
+    addResult("notify and switch");
+
+    printReport();
+    forgetTrackedTask(switchTaskHandle);
+    vTaskDelete(switchTaskHandle);
+    if (doneFunction != NULL) {
+        doneFunction();
+    }
+    forgetTrackedTask(xTaskGetCurrentTaskHandle());
+    vTaskDelete(NULL);
+}
+
+void createBenchmarkTask(void (*done)(void)) {
+    doneFunction = done;
+#if STATIC_ALLOCATION
+    logMutex = xSemaphoreCreateMutexStatic(&logMutexMemory);
+#else
+    logMutex = xSemaphoreCreateMutex();
+#endif
+    configASSERT(BENCHMARK_PRIORITY + 1 < configMAX_PRIORITIES);
+    // both on core 0: its SysTick is the timer, and the switch has to happen on one core
+    createTrackedTask(vBenchmarkTask, "Benchmark", 1024, NULL, BENCHMARK_PRIORITY, 1u << 0,
+                      STATIC_TASK_STACK(benchmarkTask, 0), STATIC_TASK_TCB(benchmarkTask, 0), NULL);
+    createTrackedTask(vSwitchTask, "Switch", 256, NULL, BENCHMARK_PRIORITY + 1, 1u << 0,
+                      STATIC_TASK_STACK(switchTask, 0), STATIC_TASK_TCB(switchTask, 0), &switchTaskHandle);
+}
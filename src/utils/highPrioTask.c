@@ -1,30 +1,34 @@
 #include "utils/highPrioTask.h"
 #include "FreeRTOS.h"
-#include "task.h"
-#include "utils/traces/traces.h"
-#include "utils/delay.h"
+#include "timers.h"
+#include "utils/aperiodicServer.h"
+#include "utils/taskMemory.h"
+#include <stdio.h>
 
-void highPrioTask(void *pvParameters) {
-    vTaskDelay(pdMS_TO_TICKS(100));
-    
-    const TickType_t period = pdMS_TO_TICKS(700);
-    TickType_t previousWakeTime = xTaskGetTickCount();
+#if STATIC_ALLOCATION
+static StaticTimer_t timerMemory;
+#endif
 
-    uint32_t taskID = 3;
-    for (;;)
-    {
-        // record the time at which the task was woken up
-        logEvent(taskID, JOB_START, (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS));
-        // do the task
-        busyDelay(100);
-        // record when the task finished
-        logEvent(taskID, JOB_COMPLETION, (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS));
-        // wait for a period (measured from the last wake up time)
-        // note that the first parameter is updated by vTaskDelayUntil to the time when the function terminates
-        vTaskDelayUntil(&previousWakeTime, period);
+// runs in the timer service task: hands the burst over and returns at once
+static void submitLoad(TimerHandle_t timer) {
+    static bool first = true;
+    if (first) {
+        // from now on with the period of the load
+        first = false;
+        xTimerChangePeriod(timer, pdMS_TO_TICKS(HIGH_PRIO_PERIOD_MS), 0);
     }
+    // rejected when the server lags behind, the server counts it
+    aperiodicSubmit(NULL, NULL, TASK_MS(HIGH_PRIO_LOAD_MS));
 }
 
 void addHighPriorityTask() {
-    xTaskCreate(highPrioTask, "high prio task", 8192, NULL, 20, NULL);
-}
\ No newline at end of file
+#if STATIC_ALLOCATION
+    TimerHandle_t timer = xTimerCreateStatic("high prio load", pdMS_TO_TICKS(HIGH_PRIO_LOAD_MS), pdTRUE, NULL,
+                                             submitLoad, &timerMemory);
+#else
+    TimerHandle_t timer = xTimerCreate("high prio load", pdMS_TO_TICKS(HIGH_PRIO_LOAD_MS), pdTRUE, NULL, submitLoad);
+#endif
+    if (timer == NULL || xTimerStart(timer, 0) != pdPASS) {
+        printf("Failed to start the high priority load!\n");
+    }
+}
@@ -0,0 +1,65 @@
+#include "utils/latencyHistogram.h"
+
+#include <string.h>
+
+static uint32_t bucketOf(uint32_t us) {
+    if (us < LATENCY_SUB_BUCKETS) {
+        return us;
+    }
+    uint32_t msb = 31 - (uint32_t)__builtin_clz(us);
+    if (msb >= LATENCY_MAX_BITS) {
+        return LATENCY_BUCKETS - 1;
+    }
+    uint32_t shift = msb - LATENCY_SUB_BUCKET_BITS;
+    return (shift + 1) * LATENCY_SUB_BUCKETS + ((us >> shift) & (LATENCY_SUB_BUCKETS - 1));
+}
+
+// largest duration that falls into `bucket`
+static uint32_t bucketUpperBound(uint32_t bucket) {
+    if (bucket < LATENCY_SUB_BUCKETS) {
+        return bucket;
+    }
+    uint32_t shift = bucket / LATENCY_SUB_BUCKETS - 1;
+    uint32_t lower = (LATENCY_SUB_BUCKETS + bucket % LATENCY_SUB_BUCKETS) << shift;
+    return lower + (1u << shift) - 1;
+}
+
+void latencyHistogramInit(LatencyHistogram *histogram) {
+    memset(histogram, 0, sizeof(*histogram));
+    histogram->min = UINT32_MAX;
+}
+
+void latencyHistogramRecord(LatencyHistogram *histogram, uint32_t us) {
+    histogram->count++;
+    histogram->sum += us;
+    if (us < histogram->min) {
+        histogram->min = us;
+    }
+    if (us > histogram->max) {
+        histogram->max = us;
+    }
+    histogram->buckets[bucketOf(us)]++;
+}
+
+uint32_t latencyHistogramPercentile(const LatencyHistogram *histogram, uint32_t permille) {
+    if (histogram->count == 0) {
+        return 0;
+    }
+    uint64_t rank = ((uint64_t)histogram->count * permille + 999) / 1000;
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (uint32_t bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+        seen += histogram->buckets[bucket];
+        if (seen >= rank && bucket < LATENCY_BUCKETS - 1) {
+            uint32_t bound = bucketUpperBound(bucket);
+            return bound < histogram->max ? bound : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+uint32_t latencyHistogramMean(const LatencyHistogram *histogram) {
+    return histogram->count > 0 ? (uint32_t)(histogram->sum / histogram->count) : 0;
+}
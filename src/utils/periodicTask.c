@@ -0,0 +1,655 @@
+#include "utils/periodicTask.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "event_groups.h"
+#include "utils/releaseAlarm.h"
+#include "utils/resource.h"
+#include "utils/taskMemory.h"
+#include "utils/traces/traces.h"
+#include "utils/workload.h"
+#include "utils/timestamp.h"
+#include <stdio.h>
+#include <string.h>
+#if PERIODIC_SCHEDULING == PERIODIC_SCHED_EDF
+#include "utils/tiebreak.h"
+#endif
+
+#define US_PER_TICK (portTICK_PERIOD_MS * TIMESTAMP_US_PER_MS)
+
+#if PERIODIC_PLACEMENT == PERIODIC_PLACEMENT_PARTITIONED && !configUSE_CORE_AFFINITY
+#error "PERIODIC_PLACEMENT_PARTITIONED needs configUSE_CORE_AFFINITY"
+#endif
+
+#if PERIODIC_RELEASE == PERIODIC_RELEASE_TICK && configUSE_TICKLESS_IDLE
+#error "PERIODIC_RELEASE_TICK needs the tick running, use PERIODIC_RELEASE_ALARM with TICKLESS_IDLE"
+#endif
+
+#if PERIODIC_SCHEDULING == PERIODIC_SCHED_EDF
+
+// EDF: every job is dispatched at PERIODIC_BASE_PRIORITY, and waits for its
+// release one level above, so that a released job always gets the CPU at once
+// to take its place in the deadline order (a ready task of equal priority never
+// preempts the running one)
+#define EDF_PRIORITY PERIODIC_BASE_PRIORITY
+#define EDF_RELEASE_PRIORITY (PERIODIC_BASE_PRIORITY + 1)
+
+// jobs dispatched and not complete yet, and the time the keys of their deadlines
+// count from. Keys only order the pending jobs, so with none pending the epoch
+// moves up to the next release and the keys stay small however long the
+// firmware runs
+static uint32_t edfPendingJobs;
+static Timestamp edfEpoch;
+
+// called by a job right after its release: key the calling task by its absolute
+// deadline and drop it to the EDF priority. Lowering the priority of the running
+// task re-inserts it, sorted by the key, in the ready list of that priority and
+// yields to the head of the list, i.e. to the earliest deadline. The cost is one
+// sorted list insertion, no task is scanned
+static void edfDispatch(Timestamp release, Timestamp absoluteDeadline) {
+    taskENTER_CRITICAL();
+    if (edfPendingJobs++ == 0) {
+        edfEpoch = release;
+    }
+    // a job released before the epoch and still pending has the earliest deadlines
+    uint64_t key = absoluteDeadline > edfEpoch ? (absoluteDeadline - edfEpoch) >> PERIODIC_EDF_KEY_SHIFT : 0;
+    taskEXIT_CRITICAL();
+    // no idle instant for 2^32 keys: past that the order would be wrong
+    configASSERT(key <= (UBaseType_t)~(UBaseType_t)0);
+    vTaskTieBreakerSet(key <= (UBaseType_t)~(UBaseType_t)0 ? (UBaseType_t)key : (UBaseType_t)~(UBaseType_t)0);
+    vTaskPrioritySet(NULL, EDF_PRIORITY);
+}
+
+// called by a job once it is over, before it waits for its next release
+static void edfComplete(void) {
+    taskENTER_CRITICAL();
+    edfPendingJobs--;
+    taskEXIT_CRITICAL();
+}
+
+#endif // PERIODIC_SCHEDULING
+
+// The periodic tasks are slots: slot i runs task i of the running mode, and the
+// slots beyond the tasks of the mode wait for the next one. The statistics are
+// those of the slot, written only by its task or while it is parked.
+static TaskStats taskStats[PERIODIC_MAX_TASKS];
+STATIC_TASKS(periodic, PERIODIC_MAX_TASKS, PERIODIC_TASK_STACK_SIZE);
+static TaskHandle_t slotHandles[PERIODIC_MAX_TASKS];
+// slots created
+static uint32_t slotCount;
+
+// no mode runs before the first switch
+#define NO_MODE UINT32_MAX
+
+// Mode change state. The fields below are written under the kernel's critical
+// section, or by the switch while every slot is parked
+static volatile uint32_t runningMode = NO_MODE;
+static volatile uint32_t requestedMode;
+static volatile bool modeChangePending;
+// a switch is claimed and under way
+static bool switching;
+// slots waiting for the next mode
+static uint32_t parkedSlots;
+static Timestamp modeChangeRequestedAt;
+// release of the first jobs of the running mode
+static Timestamp modeStart;
+static TickType_t modeStartTick;
+// one bit per slot, set by the switch to start the slot in the new mode
+static EventGroupHandle_t modeStarts;
+#if STATIC_ALLOCATION
+static StaticEventGroup_t modeStartsMemory;
+#endif
+// priority, and with partitioned placement core, of every task of every mode,
+// worked out before the scheduler starts so that the switch does no analysis
+static uint32_t modePriorities[TASK_MODE_COUNT][PERIODIC_MAX_TASKS];
+#if PERIODIC_PLACEMENT == PERIODIC_PLACEMENT_PARTITIONED
+static uint32_t modeCores[TASK_MODE_COUNT][PERIODIC_MAX_TASKS];
+#endif
+static ModeChangeStats modeChangeStats;
+
+// `to - from` in microseconds, clamped to what the histograms take
+static uint32_t elapsedUs(Timestamp from, Timestamp to) {
+    if (to <= from) {
+        return 0;
+    }
+    return to - from > UINT32_MAX ? UINT32_MAX : (uint32_t)(to - from);
+}
+
+// the release alarm of each slot while its task runs
+static ReleaseAlarm *releaseAlarms[PERIODIC_MAX_TASKS];
+
+// alarm or tick interrupt: one more release for the task whose statistics are
+// `arg`, its job loop takes them one by one
+static bool releaseJob(void *arg, Timestamp due, Timestamp fired) {
+    TaskStats *stats = (TaskStats *)arg;
+    latencyHistogramRecord(&stats->release, elapsedUs(due, fired));
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(slotHandles[stats - taskStats], &woken);
+    return woken == pdTRUE;
+}
+
+#if PERIODIC_DEADLINE_WATCHDOG
+
+// The deadline watchdog of one task. Its jobs are numbered from 0 in the order
+// of their releases, the skipped ones included, so that the deadline alarm
+// counts the deadline of job n as the nth one
+typedef struct {
+    const TaskDescriptor *task;
+    // while the task runs
+    ReleaseAlarm *alarm;
+    // deadlines passed so far, counted by the deadline alarm
+    uint32_t deadlines;
+    // jobs ended so far (completed, aborted or skipped), counted by the task
+    volatile uint32_t ended;
+    // MISS_ABORT: the jobs numbered below it are to stop, set by the deadline alarm
+    volatile uint32_t abortBelow;
+} DeadlineWatchdog;
+
+// the progress of a job, for the watchdog
+typedef struct {
+    DeadlineWatchdog *watchdog;
+    uint32_t number;
+    // 0: no budget
+    uint32_t budgetUs;
+    // run time counter of the task at the start of the job, and at the last check
+    uint32_t runTimeAtStart;
+    uint32_t runTime;
+    // since when the task has run without being switched out, as far as known
+    Timestamp runningSince;
+    bool overrun;
+} WatchedJob;
+
+static DeadlineWatchdog watchdogs[PERIODIC_MAX_TASKS];
+
+// deadline alarm of the task whose watchdog is `arg`; the counters wrap, their
+// differences do not
+static bool deadlineDue(void *arg, Timestamp due, Timestamp fired) {
+    (void)due;
+    (void)fired;
+    DeadlineWatchdog *watchdog = (DeadlineWatchdog *)arg;
+    uint32_t job = watchdog->deadlines++;
+    if ((int32_t)(watchdog->ended - job) > 0) {
+        return false;
+    }
+    // still running: logged now, from the interrupt, without waking the logging task
+    traceKernelEvent(DEADLINE_MISSED, watchdog->task->id);
+    if (watchdog->task->missPolicy == MISS_ABORT) {
+        watchdog->abortBelow = job + 1;
+    }
+    return false;
+}
+
+// processor time of the calling task in microseconds, from the kernel's run-time
+// statistics; without them (the POSIX build) it stands still, and the budget
+// of a job is then checked against the time since it started, preemptions included
+static uint32_t taskRunTimeUs(void) {
+#if configGENERATE_RUN_TIME_STATS && configUSE_TRACE_FACILITY
+    TaskStatus_t status;
+    // given the state, the kernel does not work it out
+    vTaskGetInfo(NULL, &status, pdFALSE, eRunning);
+    return (uint32_t)status.ulRunTimeCounter;
+#else
+    return 0;
+#endif
+}
+
+static void watchedJobStart(WatchedJob *job, DeadlineWatchdog *watchdog, uint32_t budgetUs) {
+    job->watchdog = watchdog;
+    job->number = watchdog->ended;
+    job->budgetUs = budgetUs;
+    job->runTimeAtStart = taskRunTimeUs();
+    job->runTime = job->runTimeAtStart;
+    job->runningSince = timestampNow();
+    job->overrun = false;
+}
+
+// whether the job has used up its budget. The kernel only adds to the run time
+// of a task when it is switched out, the time since it resumed comes from the
+// clock: from the first check that sees the counter move, so a switch costs the
+// count at most the part of one slice run before that check
+static bool watchedJobOverran(WatchedJob *job) {
+    if (job->budgetUs == 0 || job->overrun) {
+        return job->overrun;
+    }
+    Timestamp now = timestampNow();
+    uint32_t runTime = taskRunTimeUs();
+    if (runTime != job->runTime) {
+        job->runTime = runTime;
+        job->runningSince = now;
+    }
+    uint64_t usedUs = (uint64_t)(runTime - job->runTimeAtStart) + (now - job->runningSince);
+    job->overrun = usedUs > job->budgetUs;
+    return job->overrun;
+}
+
+// run `us` of the work of a job in slices, checking the watchdog in between;
+// false if the job is to stop first (MISS_ABORT, at its deadline or budget).
+// Nothing stops the jobs of the other policies: their work runs in one go and
+// the budget is only checked once the job is over, a lower bound there (see
+// PERIODIC_BUDGET_PERCENT)
+static bool watchedJobRun(WatchedJob *job, uint32_t us) {
+    bool abortable = job->watchdog->task->missPolicy == MISS_ABORT;
+    if (!abortable) {
+        workloadRun(us);
+        return true;
+    }
+    while (us > 0) {
+        uint32_t slice = us < PERIODIC_WATCHDOG_SLICE_US ? us : PERIODIC_WATCHDOG_SLICE_US;
+        workloadRun(slice);
+        us -= slice;
+        if ((int32_t)(job->watchdog->abortBelow - job->number) > 0) {
+            return false;
+        }
+        if (watchedJobOverran(job)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif // PERIODIC_DEADLINE_WATCHDOG
+
+static void resetTaskStats(TaskStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    latencyHistogramInit(&stats->response);
+    latencyHistogramInit(&stats->startLatency);
+    latencyHistogramInit(&stats->jitter);
+    latencyHistogramInit(&stats->release);
+}
+
+// under the kernel's critical section: whether the caller is to run the switch,
+// once every slot is parked and a mode was requested
+static bool claimSwitch(void) {
+    if (!modeChangePending || switching || parkedSlots < slotCount) {
+        return false;
+    }
+    switching = true;
+    return true;
+}
+
+// Switch to `requestedMode`, with every slot parked: no job of the old mode is
+// left, so the new one starts from a synchronous release of all its tasks, the
+// critical instant the analysis of each mode assumes
+static void switchMode(void) {
+    uint32_t mode = requestedMode;
+    const TaskMode *next = &taskModes[mode];
+    for (uint32_t slot = 0; slot < slotCount && slot < next->count; slot++) {
+        vTaskPrioritySet(slotHandles[slot], modePriorities[mode][slot]);
+#if PERIODIC_PLACEMENT == PERIODIC_PLACEMENT_PARTITIONED
+        vTaskCoreAffinitySet(slotHandles[slot], (UBaseType_t)1 << modeCores[mode][slot]);
+#endif
+#if configUSE_TRACE_FACILITY
+        vTaskSetTaskNumber(slotHandles[slot], next->tasks[slot].id);
+#endif
+        resetTaskStats(&taskStats[slot]);
+    }
+    setResourceCeilings(next->tasks, next->count, modePriorities[mode]);
+
+    modeStartTick = xTaskGetTickCount();
+    modeStart = timestampNow();
+    // the alarms of the new mode count from its release
+    for (uint32_t slot = 0; slot < slotCount && slot < next->count; slot++) {
+        const TaskDescriptor *task = &next->tasks[slot];
+#if PERIODIC_RELEASE == PERIODIC_RELEASE_ALARM
+        releaseAlarms[slot] = releaseAlarmStart(modeStart + task->periodUs, task->periodUs, releaseJob,
+                                                &taskStats[slot]);
+#else
+        uint32_t periodTicks = task->periodUs / US_PER_TICK;
+        releaseAlarms[slot] = releaseAlarmStartOnTick(modeStartTick + periodTicks, periodTicks, releaseJob,
+                                                      &taskStats[slot]);
+#endif
+        if (releaseAlarms[slot] == NULL) {
+            printf("Failed to start the release alarm of task %u!\n", (unsigned)task->id);
+        }
+#if PERIODIC_DEADLINE_WATCHDOG
+        DeadlineWatchdog *watchdog = &watchdogs[slot];
+        watchdog->task = task;
+        watchdog->deadlines = 0;
+        watchdog->ended = 0;
+        watchdog->abortBelow = 0;
+        watchdog->alarm = releaseAlarmStart(modeStart + task->deadlineUs, task->periodUs, deadlineDue, watchdog);
+        if (watchdog->alarm == NULL) {
+            printf("Failed to start the deadline watchdog of task %u!\n", (unsigned)task->id);
+        }
+#endif
+    }
+    if (runningMode != NO_MODE) {
+        modeChangeStats.lastLatencyUs = elapsedUs(modeChangeRequestedAt, modeStart);
+        latencyHistogramRecord(&modeChangeStats.latency, modeChangeStats.lastLatencyUs);
+        // last: the console waits for it
+        modeChangeStats.changes++;
+    }
+    modeChangeStats.mode = mode;
+    logEvent(mode, MODE_CHANGED, modeStart);
+
+    taskENTER_CRITICAL();
+    runningMode = mode;
+    parkedSlots = 0;
+    modeChangePending = false;
+    switching = false;
+    taskEXIT_CRITICAL();
+    // the slots above the caller preempt it from here
+    xEventGroupSetBits(modeStarts, ((EventBits_t)1 << slotCount) - 1);
+}
+
+// leave the running mode: wait for the next one, running the switch if the
+// calling slot is the last one to park
+static void parkSlot(uint32_t slot) {
+    if (releaseAlarms[slot] != NULL) {
+        releaseAlarmStop(releaseAlarms[slot]);
+        releaseAlarms[slot] = NULL;
+    }
+#if PERIODIC_DEADLINE_WATCHDOG
+    if (watchdogs[slot].alarm != NULL) {
+        releaseAlarmStop(watchdogs[slot].alarm);
+        watchdogs[slot].alarm = NULL;
+    }
+#endif
+    taskENTER_CRITICAL();
+    // releases of the old mode not taken yet, and the wake-up of the request
+    ulTaskNotifyTake(pdTRUE, 0);
+    parkedSlots++;
+    bool last = claimSwitch();
+    taskEXIT_CRITICAL();
+    if (last) {
+        switchMode();
+    }
+    xEventGroupWaitBits(modeStarts, (EventBits_t)1 << slot, pdTRUE, pdTRUE, portMAX_DELAY);
+}
+
+// the jobs of `task` in `slot`, from the start of the running mode until a mode
+// change is requested
+static void runJobs(uint32_t slot, const TaskDescriptor *task) {
+    TaskStats *stats = &taskStats[slot];
+    WorkloadSequence workload;
+    workloadSequenceInit(&workload, task->workload, task->wcetUs, task->id);
+    // part of every job spent in critical sections on the shared resources
+    uint32_t criticalUs = 0;
+    for (uint32_t r = 0; r < resourceSetSize; r++) {
+        if (resourceUsedBy(&resourceSet[r], task->id)) {
+            criticalUs += resourceSet[r].holdUs;
+        }
+    }
+    // release time of the current job, the first one is released with the mode
+    Timestamp release = modeStart;
+#if PERIODIC_DEADLINE_WATCHDOG
+    DeadlineWatchdog *watchdog = &watchdogs[slot];
+    uint32_t budgetUs = (uint32_t)((uint64_t)task->wcetUs * PERIODIC_BUDGET_PERCENT / 100);
+#endif
+    Timestamp start;
+    Timestamp completion;
+    // start of the previous job, 0 before the first one
+    Timestamp previousStart = 0;
+
+    while (!modeChangePending) {
+#if PERIODIC_SCHEDULING == PERIODIC_SCHED_EDF
+        edfDispatch(release, release + task->deadlineUs);
+#endif
+        // record the time at which the task started the execution of a job
+        start = timestampNow();
+        logEvent(task->id, JOB_START, start);
+        uint32_t cost = workloadSequenceNext(&workload);
+#if PERIODIC_DEADLINE_WATCHDOG
+        WatchedJob job;
+        watchedJobStart(&job, watchdog, budgetUs);
+        bool completed = watchedJobRun(&job, cost > criticalUs ? cost - criticalUs : 0);
+#else
+        workloadRun(cost > criticalUs ? cost - criticalUs : 0);
+        bool completed = true;
+#endif
+        // the critical sections end the job, an aborted job never enters them
+        for (uint32_t r = 0; completed && criticalUs > 0 && r < resourceSetSize; r++) {
+            if (resourceUsedBy(&resourceSet[r], task->id)) {
+                resourceAcquire(r);
+                workloadRun(resourceSet[r].holdUs);
+                resourceRelease(r);
+            }
+        }
+        // Code to detect misses, at microsecond resolution
+        completion = timestampNow();
+        bool late = completion > release + task->deadlineUs;
+        if (late || !completed) {
+            stats->missed++;
+        } else {
+            stats->met++;
+        }
+        if (completed) {
+            // record the time at which the task completed the execution of a job
+            logEvent(task->id, JOB_COMPLETION, completion);
+            latencyHistogramRecord(&stats->response, elapsedUs(release, completion));
+        } else {
+            logEvent(task->id, JOB_ABORTED, completion);
+            stats->aborted++;
+        }
+        latencyHistogramRecord(&stats->startLatency, elapsedUs(release, start));
+        if (previousStart != 0) {
+            uint32_t interval = elapsedUs(previousStart, start);
+            latencyHistogramRecord(&stats->jitter, interval > task->periodUs ? interval - task->periodUs
+                                                                             : task->periodUs - interval);
+        }
+        previousStart = start;
+        release += task->periodUs;
+        // releases to wait for: the next one, and the one after if the next job is dropped
+        uint32_t releases = 1;
+#if PERIODIC_DEADLINE_WATCHDOG
+        if (watchedJobOverran(&job)) {
+            stats->overruns++;
+        }
+        if (task->missPolicy == MISS_SKIP_NEXT && (late || job.overrun)) {
+            releases = 2;
+        }
+        // the dropped job is over before its release, its deadline alarm is quiet
+        watchdog->ended += releases;
+#endif
+#if PERIODIC_SCHEDULING == PERIODIC_SCHED_EDF
+        // wait for the next release above the EDF priority, see edfDispatch()
+        edfComplete();
+        vTaskPrioritySet(NULL, EDF_RELEASE_PRIORITY);
+#endif
+        for (; releases > 0 && !modeChangePending; releases--) {
+            // one notification per release: a job completing late finds the next
+            // release already counted and goes on at once; a mode change request
+            // wakes the task up too
+            ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+            if (releases > 1 && !modeChangePending) {
+                logEvent(task->id, JOB_SKIPPED, timestampNow());
+                stats->skipped++;
+                release += task->periodUs;
+            }
+        }
+    }
+}
+
+// the task of a slot, `pvParameters` is the slot: runs task `slot` of every
+// mode that has one
+static void vPeriodicTask(void *pvParameters) {
+    uint32_t slot = (uint32_t)(uintptr_t)pvParameters;
+    for (;;) {
+        parkSlot(slot);
+        const TaskMode *mode = &taskModes[runningMode];
+        if (slot < mode->count) {
+            runJobs(slot, &mode->tasks[slot]);
+        }
+    }
+}
+
+// work out the priorities (and cores) of the tasks of `mode`
+static void planMode(uint32_t mode) {
+    const TaskMode *plan = &taskModes[mode];
+    uint32_t *priorities = modePriorities[mode];
+    configASSERT(plan->count <= PERIODIC_MAX_TASKS);
+
+#if PERIODIC_SCHEDULING == PERIODIC_SCHED_EDF
+    // the tasks start waiting for their first release
+    for (uint32_t i = 0; i < plan->count; i++) {
+        priorities[i] = EDF_RELEASE_PRIORITY;
+    }
+    configASSERT(EDF_RELEASE_PRIORITY < configMAX_PRIORITIES);
+#else
+    uint32_t highest = taskSetAssignPriorities(plan->tasks, plan->count, PERIODIC_PRIORITY_POLICY,
+                                               PERIODIC_BASE_PRIORITY, priorities);
+    configASSERT(highest < configMAX_PRIORITIES);
+    (void)highest;
+#endif
+
+#if PERIODIC_PLACEMENT == PERIODIC_PLACEMENT_PARTITIONED
+    // fixed priority is tested on the priorities just assigned, EDF on densities
+    uint32_t *coreOf = modeCores[mode];
+    bool fits = taskSetPartition(plan->tasks, plan->count,
+                                 PERIODIC_SCHEDULING == PERIODIC_SCHED_EDF ? NULL : priorities,
+                                 configNUM_CORES, PERIODIC_PARTITION_HEURISTIC, coreOf);
+    if (!fits) {
+        printf("Warning: the tasks of mode %s do not fit on %u cores!\n", plan->name, (unsigned)configNUM_CORES);
+    }
+    // the ceiling only keeps the users of one core apart
+    for (uint32_t r = 0; r < resourceSetSize; r++) {
+        int32_t core = -1;
+        for (uint32_t i = 0; i < plan->count; i++) {
+            if (!resourceUsedBy(&resourceSet[r], plan->tasks[i].id)) {
+                continue;
+            }
+            if (core >= 0 && (uint32_t)core != coreOf[i]) {
+                printf("Warning: resource %u is shared across cores in mode %s!\n", (unsigned)resourceSet[r].id,
+                       plan->name);
+                break;
+            }
+            core = (int32_t)coreOf[i];
+        }
+    }
+    for (uint32_t i = 0; i < plan->count; i++) {
+        printf("Task %u on core %u in mode %s\n", (unsigned)plan->tasks[i].id, (unsigned)coreOf[i], plan->name);
+    }
+#endif
+#if PERIODIC_RELEASE == PERIODIC_RELEASE_TICK
+    // releases are driven by the tick
+    for (uint32_t i = 0; i < plan->count; i++) {
+        configASSERT(plan->tasks[i].periodUs % US_PER_TICK == 0);
+    }
+#endif
+}
+
+void createPeriodicTasks() {
+    _Static_assert(PERIODIC_MAX_TASKS <= 24, "the slots are bits of an event group");
+    configASSERT(taskModeCount == TASK_MODE_COUNT && taskModes[0].tasks == taskSet);
+    for (uint32_t mode = 0; mode < taskModeCount; mode++) {
+        planMode(mode);
+    }
+    createResources(modePriorities[0]);
+#if STATIC_ALLOCATION
+    modeStarts = xEventGroupCreateStatic(&modeStartsMemory);
+#else
+    modeStarts = xEventGroupCreate();
+#endif
+    if (modeStarts == NULL) {
+        printf("Failed to create the mode change events!\n");
+        return;
+    }
+    latencyHistogramInit(&modeChangeStats.latency);
+    // the slots start parked with the first mode requested, which releases its
+    // tasks together once they all are
+    requestedMode = 0;
+    modeChangePending = true;
+
+#if PERIODIC_STATS_REPORT_PERIOD_MS > 0
+    setLoggerReport(reportPeriodicTaskStats, PERIODIC_STATS_REPORT_PERIOD_MS);
+#endif
+    for (uint32_t slot = 0; slot < PERIODIC_MAX_TASKS; slot++) {
+        resetTaskStats(&taskStats[slot]);
+        char name[configMAX_TASK_NAME_LEN];
+        snprintf(name, sizeof(name), "Periodic %u", (unsigned)slot);
+        // as in the first mode, set again by every switch
+        bool inFirst = slot < taskModes[0].count;
+        UBaseType_t priority = inFirst ? modePriorities[0][slot] : PERIODIC_BASE_PRIORITY;
+#if PERIODIC_PLACEMENT == PERIODIC_PLACEMENT_PARTITIONED
+        UBaseType_t coreMask = inFirst ? (UBaseType_t)1 << modeCores[0][slot] : TASK_ANY_CORE;
+#else
+        UBaseType_t coreMask = TASK_ANY_CORE;
+#endif
+        BaseType_t created = createTrackedTask(vPeriodicTask, name, PERIODIC_TASK_STACK_SIZE,
+                                               (void *)(uintptr_t)slot, priority, coreMask,
+                                               STATIC_TASK_STACK(periodic, slot), STATIC_TASK_TCB(periodic, slot),
+                                               &slotHandles[slot]);
+        if (created != pdPASS) {
+            // the slots are numbered without gaps, the modes run on those created
+            printf("Failed to create periodic task %u!\n", (unsigned)slot);
+            break;
+        }
+        slotCount++;
+    }
+}
+
+bool requestModeChange(uint32_t mode) {
+    if (mode >= taskModeCount) {
+        return false;
+    }
+    taskENTER_CRITICAL();
+    if (modeChangePending) {
+        taskEXIT_CRITICAL();
+        return false;
+    }
+    uint32_t running = runningMode;
+    requestedMode = mode;
+    modeChangeRequestedAt = timestampNow();
+    modeChangePending = true;
+    // a mode without tasks has every slot parked already
+    bool last = claimSwitch();
+    // The tasks waiting for their next release leave at once, the others after
+    // their job in progress. A notification sent before a task blocks is kept
+    // for its wait; sent in the same critical section that publishes the
+    // request, none arrives after the task has parked and cleared them
+    for (uint32_t slot = 0; !last && slot < slotCount && slot < taskModes[running].count; slot++) {
+        xTaskNotifyGive(slotHandles[slot]);
+    }
+    taskEXIT_CRITICAL();
+    logEvent(mode, MODE_CHANGE_REQUESTED, modeChangeRequestedAt);
+    if (last) {
+        switchMode();
+    }
+    return true;
+}
+
+const TaskMode *getCurrentMode(void) {
+    uint32_t mode = runningMode;
+    return &taskModes[mode == NO_MODE ? 0 : mode];
+}
+
+const ModeChangeStats *getModeChangeStats(void) {
+    return &modeChangeStats;
+}
+
+const TaskStats *getPeriodicTaskStats(uint32_t index) {
+    return index < getCurrentMode()->count && index < slotCount ? &taskStats[index] : NULL;
+}
+
+static void printHistogram(const char *name, const LatencyHistogram *histogram) {
+    printf(" %s %u/%u/%u/%u/%u/%u", name,
+           (unsigned)(histogram->count > 0 ? histogram->min : 0),
+           (unsigned)latencyHistogramMean(histogram),
+           (unsigned)latencyHistogramPercentile(histogram, 500),
+           (unsigned)latencyHistogramPercentile(histogram, 990),
+           (unsigned)latencyHistogramPercentile(histogram, 999),
+           (unsigned)histogram->max);
+}
+
+void reportPeriodicTaskStats() {
+    const TaskMode *mode = getCurrentMode();
+    printf("stats (min/mean/p50/p99/p99.9/max us)\n");
+    printf("stats mode %s: %u changes;", mode->name, (unsigned)modeChangeStats.changes);
+    printHistogram("latency", &modeChangeStats.latency);
+    printf("\n");
+    for (uint32_t i = 0; i < mode->count && i < slotCount; i++) {
+        const TaskStats *stats = &taskStats[i];
+        printf("stats task %u: %u met %u missed;", (unsigned)mode->tasks[i].id, (unsigned)stats->met,
+               (unsigned)stats->missed);
+#if PERIODIC_DEADLINE_WATCHDOG
+        printf(" %u aborted %u skipped %u overruns;", (unsigned)stats->aborted, (unsigned)stats->skipped,
+               (unsigned)stats->overruns);
+#endif
+        printHistogram("response", &stats->response);
+        printHistogram("start", &stats->startLatency);
+        printHistogram("jitter", &stats->jitter);
+#if PERIODIC_RELEASE == PERIODIC_RELEASE_ALARM
+        printHistogram("release", &stats->release);
+#endif
+        printf("\n");
+    }
+}
@@ -0,0 +1,148 @@
+#include "utils/releaseAlarm.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+struct ReleaseAlarm {
+    // in microseconds, or in ticks for an alarm on the tick
+    Timestamp due;
+    uint32_t period;
+    bool onTick;
+    // NULL while the alarm is free
+    ReleaseAlarmCallback callback;
+    void *arg;
+#ifndef HOST_FREERTOS
+    int32_t poolId;
+#endif
+};
+
+static ReleaseAlarm alarms[RELEASE_ALARMS_MAX];
+// alarms ever taken, the free ones among them included
+static uint32_t alarmCount;
+
+// claim a free alarm, NULL once all are taken
+static ReleaseAlarm *newAlarm(Timestamp first, uint32_t period, bool onTick, ReleaseAlarmCallback callback,
+                              void *arg) {
+    ReleaseAlarm *alarm = NULL;
+    taskENTER_CRITICAL();
+    for (uint32_t i = 0; i < alarmCount && alarm == NULL; i++) {
+        if (alarms[i].callback == NULL) {
+            alarm = &alarms[i];
+        }
+    }
+    if (alarm == NULL && alarmCount < RELEASE_ALARMS_MAX) {
+        alarm = &alarms[alarmCount++];
+    }
+    if (alarm != NULL) {
+        alarm->due = first;
+        alarm->period = period;
+        alarm->onTick = onTick;
+        alarm->arg = arg;
+        // last: the alarm is in use from here
+        alarm->callback = callback;
+    }
+    taskEXIT_CRITICAL();
+    return alarm;
+}
+
+// run the callback of an alarm that is due, and move it on to its next due time
+static bool fire(ReleaseAlarm *alarm, Timestamp now) {
+    bool yield = alarm->callback(alarm->arg, alarm->due, now);
+    alarm->due += alarm->period;
+    return yield;
+}
+
+// whether the tick count `now` has come to the tick `due`, across its wrap
+static bool tickReached(TickType_t now, TickType_t due) {
+    return (TickType_t)(now - due) <= portMAX_DELAY / 2;
+}
+
+// The tick interrupt fires the alarms on the tick, and in the POSIX build the
+// others too, standing in for the alarm interrupt. A task woken from the tick
+// hook is switched to by the kernel at the end of the tick
+void vApplicationTickHook(void) {
+    TickType_t tick = xTaskGetTickCountFromISR();
+    Timestamp now = timestampNow();
+    for (uint32_t i = 0; i < alarmCount; i++) {
+        ReleaseAlarm *alarm = &alarms[i];
+        // every due time passed since the previous tick, in order
+        if (alarm->onTick) {
+            while (alarm->callback != NULL && tickReached(tick, (TickType_t)alarm->due)) {
+                // the tick it was due on is the one firing it
+                alarm->callback(alarm->arg, now, now);
+                alarm->due = (TickType_t)(alarm->due + alarm->period);
+            }
+        }
+#ifdef HOST_FREERTOS
+        else {
+            while (alarm->callback != NULL && alarm->due <= now) {
+                fire(alarm, now);
+            }
+        }
+#endif
+    }
+}
+
+ReleaseAlarm *releaseAlarmStartOnTick(uint32_t firstTick, uint32_t periodTicks, ReleaseAlarmCallback callback,
+                                      void *arg) {
+    return newAlarm(firstTick, periodTicks, true, callback, arg);
+}
+
+#ifdef HOST_FREERTOS
+
+ReleaseAlarm *releaseAlarmStart(Timestamp first, uint32_t periodUs, ReleaseAlarmCallback callback, void *arg) {
+    return newAlarm(first, periodUs, false, callback, arg);
+}
+
+void releaseAlarmStop(ReleaseAlarm *alarm) {
+    // the tick hook runs with the kernel's critical section held
+    taskENTER_CRITICAL();
+    alarm->callback = NULL;
+    taskEXIT_CRITICAL();
+}
+
+#else
+
+#include "pico/time.h"
+
+static int64_t onAlarm(alarm_id_t id, void *userData) {
+    (void)id;
+    ReleaseAlarm *alarm = (ReleaseAlarm *)userData;
+    if (alarm->callback == NULL) {
+        // stopped while it was pending
+        return 0;
+    }
+    bool yield = fire(alarm, timestampNow());
+    portYIELD_FROM_ISR(yield);
+    // positive: due again this long after it was due this time, which the alarm
+    // pool fires at once when already past; 0 if stopped from the other core meanwhile
+    return alarm->callback != NULL ? alarm->period : 0;
+}
+
+ReleaseAlarm *releaseAlarmStart(Timestamp first, uint32_t periodUs, ReleaseAlarmCallback callback, void *arg) {
+    ReleaseAlarm *alarm = newAlarm(first, periodUs, false, callback, arg);
+    if (alarm == NULL) {
+        return NULL;
+    }
+    // not fired from here if already due: the callback is for interrupt context
+    alarm->poolId = add_alarm_at(from_us_since_boot(first), onAlarm, alarm, false);
+    if (alarm->poolId <= 0) {
+        alarm->callback = NULL;
+        return NULL;
+    }
+    return alarm;
+}
+
+void releaseAlarmStop(ReleaseAlarm *alarm) {
+    if (alarm->onTick) {
+        // the tick hook runs with the kernel's critical section held
+        taskENTER_CRITICAL();
+        alarm->callback = NULL;
+        taskEXIT_CRITICAL();
+        return;
+    }
+    // first, so that an alarm firing meanwhile does not call back or come again
+    alarm->callback = NULL;
+    cancel_alarm(alarm->poolId);
+}
+
+#endif // HOST_FREERTOS
@@ -0,0 +1,123 @@
+#include "utils/resource.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "utils/periodicTask.h"
+#include "utils/taskMemory.h"
+#include "utils/timestamp.h"
+#include "utils/traces/traces.h"
+#include <stdio.h>
+
+typedef struct {
+    SemaphoreHandle_t mutex;
+    UBaseType_t ceiling;
+    // holder only: its priority before the acquire, and when it got the resource
+    UBaseType_t previousPriority;
+    Timestamp acquired;
+} Resource;
+
+static Resource resources[RESOURCE_SET_SIZE];
+#if STATIC_ALLOCATION
+static StaticSemaphore_t mutexMemory[RESOURCE_SET_SIZE];
+#endif
+// written by the holder of each resource
+static ResourceStats resourceStats[RESOURCE_SET_SIZE];
+
+// `to - from` in microseconds, clamped to what the histograms take
+static uint32_t elapsedUs(Timestamp from, Timestamp to) {
+    if (to <= from) {
+        return 0;
+    }
+    return to - from > UINT32_MAX ? UINT32_MAX : (uint32_t)(to - from);
+}
+
+// the ids of the `count` tasks of `tasks`
+static const uint32_t *taskIds(const TaskDescriptor *tasks, uint32_t count) {
+    static uint32_t ids[PERIODIC_MAX_TASKS];
+    for (uint32_t i = 0; i < count; i++) {
+        ids[i] = tasks[i].id;
+    }
+    return ids;
+}
+
+void setResourceCeilings(const TaskDescriptor *tasks, uint32_t count, const uint32_t *priorities) {
+    const uint32_t *ids = taskIds(tasks, count);
+    for (uint32_t r = 0; r < resourceSetSize; r++) {
+        resources[r].ceiling = resourceCeiling(&resourceSet[r], ids, priorities, count);
+        configASSERT(resources[r].ceiling < configMAX_PRIORITIES);
+    }
+}
+
+void createResources(const uint32_t *priorities) {
+    static uint32_t blocking[PERIODIC_MAX_TASKS];
+    setResourceCeilings(taskSet, taskSetSize, priorities);
+    for (uint32_t r = 0; r < resourceSetSize; r++) {
+#if STATIC_ALLOCATION
+        resources[r].mutex = xSemaphoreCreateMutexStatic(&mutexMemory[r]);
+#else
+        resources[r].mutex = xSemaphoreCreateMutex();
+#endif
+        if (resources[r].mutex == NULL) {
+            printf("Failed to create resource %u!\n", (unsigned)resourceSet[r].id);
+        }
+        latencyHistogramInit(&resourceStats[r].wait);
+        latencyHistogramInit(&resourceStats[r].hold);
+    }
+    // the bounds the analysis uses, to compare with the measured hold times
+    resourceBlocking(resourceSet, resourceSetSize, taskIds(taskSet, taskSetSize), priorities, taskSetSize,
+                     blocking);
+    for (uint32_t i = 0; i < taskSetSize; i++) {
+        if (blocking[i] > 0) {
+            printf("Task %u blocked at most %u us per job\n", (unsigned)taskSet[i].id, (unsigned)blocking[i]);
+        }
+    }
+#if PERIODIC_STATS_REPORT_PERIOD_MS > 0
+    setLoggerReport(reportResourceStats, PERIODIC_STATS_REPORT_PERIOD_MS);
+#endif
+}
+
+void resourceAcquire(uint32_t index) {
+    Resource *resource = &resources[index];
+    ResourceStats *stats = &resourceStats[index];
+    Timestamp start = timestampNow();
+    UBaseType_t previous = uxTaskPriorityGet(NULL);
+    if (resource->ceiling > previous) {
+        vTaskPrioritySet(NULL, resource->ceiling);
+    }
+    // free unless a user on the other core holds it
+    xSemaphoreTake(resource->mutex, portMAX_DELAY);
+    resource->previousPriority = previous;
+    resource->acquired = timestampNow();
+    stats->acquires++;
+    latencyHistogramRecord(&stats->wait, elapsedUs(start, resource->acquired));
+}
+
+void resourceRelease(uint32_t index) {
+    Resource *resource = &resources[index];
+    ResourceStats *stats = &resourceStats[index];
+    uint32_t held = elapsedUs(resource->acquired, timestampNow());
+    latencyHistogramRecord(&stats->hold, held);
+    if (held > resourceSet[index].holdUs) {
+        stats->overruns++;
+    }
+    UBaseType_t previous = resource->previousPriority;
+    xSemaphoreGive(resource->mutex);
+    if (resource->ceiling > previous) {
+        // a task released meanwhile and above `previous` runs from here
+        vTaskPrioritySet(NULL, previous);
+    }
+}
+
+const ResourceStats *getResourceStats(uint32_t index) {
+    return index < resourceSetSize ? &resourceStats[index] : NULL;
+}
+
+void reportResourceStats(void) {
+    for (uint32_t r = 0; r < resourceSetSize; r++) {
+        const ResourceStats *stats = &resourceStats[r];
+        printf("resource %u (ceiling %u): %u acquires, wait max %u us, hold p50/max %u/%u us of %u, %u overruns\n",
+               (unsigned)resourceSet[r].id, (unsigned)resources[r].ceiling, (unsigned)stats->acquires,
+               (unsigned)stats->wait.max, (unsigned)latencyHistogramPercentile(&stats->hold, 500),
+               (unsigned)stats->hold.max, (unsigned)resourceSet[r].holdUs, (unsigned)stats->overruns);
+    }
+}
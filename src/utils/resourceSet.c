@@ -0,0 +1,45 @@
+#include "utils/resourceSet.h"
+
+bool resourceUsedBy(const ResourceDescriptor *resource, uint32_t taskId) {
+    for (uint32_t u = 0; u < RESOURCE_MAX_USERS; u++) {
+        if (resource->users[u] != 0 && resource->users[u] == taskId) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t resourceCeiling(const ResourceDescriptor *resource, const uint32_t *ids, const uint32_t *priorities,
+                         uint32_t count) {
+    uint32_t ceiling = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (resourceUsedBy(resource, ids[i]) && priorities[i] > ceiling) {
+            ceiling = priorities[i];
+        }
+    }
+    return ceiling;
+}
+
+void resourceBlocking(const ResourceDescriptor *resources, uint32_t resourceCount, const uint32_t *ids,
+                      const uint32_t *priorities, uint32_t count, uint32_t *blocking) {
+    for (uint32_t i = 0; i < count; i++) {
+        blocking[i] = 0;
+    }
+    for (uint32_t r = 0; r < resourceCount; r++) {
+        const ResourceDescriptor *resource = &resources[r];
+        uint32_t ceiling = resourceCeiling(resource, ids, priorities, count);
+        // the lowest priority among its users: every task above it, up to the
+        // ceiling, can find the resource held
+        uint32_t lowest = UINT32_MAX;
+        for (uint32_t j = 0; j < count; j++) {
+            if (resourceUsedBy(resource, ids[j]) && priorities[j] < lowest) {
+                lowest = priorities[j];
+            }
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            if (priorities[i] > lowest && priorities[i] <= ceiling && resource->holdUs > blocking[i]) {
+                blocking[i] = resource->holdUs;
+            }
+        }
+    }
+}
@@ -0,0 +1,115 @@
+#include "utils/taskMemory.h"
+#include "timers.h"
+#include <stdio.h>
+#include <stdlib.h>
+#ifndef HOST_BUILD
+#include "pico/stdlib.h"
+#endif
+
+typedef struct {
+    TaskHandle_t handle;
+    uint32_t depth;
+} TrackedTask;
+
+static TrackedTask trackedTasks[TRACKED_TASKS_MAX];
+static uint32_t trackedCount;
+
+BaseType_t createTrackedTask(TaskFunction_t code, const char *name, uint32_t depth, void *parameters,
+                             UBaseType_t priority, UBaseType_t coreMask, StackType_t *stack, StaticTask_t *tcb,
+                             TaskHandle_t *handle) {
+    TaskHandle_t created;
+#if STATIC_ALLOCATION
+    configASSERT(stack != NULL && tcb != NULL);
+#if configUSE_CORE_AFFINITY && configNUM_CORES > 1
+    created = xTaskCreateStaticAffinitySet(code, name, depth, parameters, priority, stack, tcb, coreMask);
+#else
+    (void)coreMask;
+    created = xTaskCreateStatic(code, name, depth, parameters, priority, stack, tcb);
+#endif
+    if (created == NULL) {
+        return pdFAIL;
+    }
+#else
+    (void)stack;
+    (void)tcb;
+#if configUSE_CORE_AFFINITY && configNUM_CORES > 1
+    if (xTaskCreateAffinitySet(code, name, depth, parameters, priority, coreMask, &created) != pdPASS) {
+        return pdFAIL;
+    }
+#else
+    (void)coreMask;
+    if (xTaskCreate(code, name, depth, parameters, priority, &created) != pdPASS) {
+        return pdFAIL;
+    }
+#endif
+#endif
+    if (trackedCount < TRACKED_TASKS_MAX) {
+        trackedTasks[trackedCount].handle = created;
+        trackedTasks[trackedCount].depth = depth;
+        trackedCount++;
+    }
+    if (handle != NULL) {
+        *handle = created;
+    }
+    return pdPASS;
+}
+
+void forgetTrackedTask(TaskHandle_t handle) {
+    for (uint32_t i = 0; i < trackedCount; i++) {
+        if (trackedTasks[i].handle == handle) {
+            trackedTasks[i] = trackedTasks[--trackedCount];
+            return;
+        }
+    }
+}
+
+static void printStackUsage(TaskHandle_t handle, uint32_t depth) {
+    // the high watermark is the least free stack ever seen, in words
+    uint32_t unused = (uint32_t)uxTaskGetStackHighWaterMark(handle);
+    printf("stack %s: %u of %u words used\n", pcTaskGetName(handle), (unsigned)(depth - unused),
+           (unsigned)depth);
+}
+
+void reportStackUsage(void) {
+    for (uint32_t i = 0; i < trackedCount; i++) {
+        printStackUsage(trackedTasks[i].handle, trackedTasks[i].depth);
+    }
+#if configUSE_TIMERS && INCLUDE_xTimerGetTimerDaemonTaskHandle
+    printStackUsage(xTimerGetTimerDaemonTaskHandle(), configTIMER_TASK_STACK_DEPTH);
+#endif
+}
+
+#if configCHECK_FOR_STACK_OVERFLOW
+// checked by the kernel at every switch out of a task
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName) {
+    (void)xTask;
+#ifdef HOST_BUILD
+    fprintf(stderr, "Stack overflow in %s!\n", pcTaskName);
+    abort();
+#else
+    panic("Stack overflow in %s!\n", pcTaskName);
+#endif
+}
+#endif
+
+#if STATIC_ALLOCATION
+// the kernel's own tasks: the idle task of core 0 (the other cores' idle tasks
+// are allocated by the kernel) and the timer service task
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer,
+                                   uint32_t *pulIdleTaskStackSize) {
+    static StaticTask_t idleTcb;
+    static StackType_t idleStack[configMINIMAL_STACK_SIZE];
+    *ppxIdleTaskTCBBuffer = &idleTcb;
+    *ppxIdleTaskStackBuffer = idleStack;
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer,
+                                    uint32_t *pulTimerTaskStackSize) {
+    static StaticTask_t timerTcb;
+    static StackType_t timerStack[configTIMER_TASK_STACK_DEPTH];
+    *ppxTimerTaskTCBBuffer = &timerTcb;
+    *ppxTimerTaskStackBuffer = timerStack;
+    *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+#endif
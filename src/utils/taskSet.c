@@ -0,0 +1,149 @@
+#include "utils/taskSet.h"
+
+#include <stddef.h>
+
+// the value that orders tasks under `policy`, smaller means more urgent
+static uint32_t urgencyKey(const TaskDescriptor *task, PriorityPolicy policy) {
+    return policy == PRIORITY_DEADLINE_MONOTONIC ? task->deadlineUs : task->periodUs;
+}
+
+uint32_t taskSetAssignPriorities(const TaskDescriptor *tasks, uint32_t count, PriorityPolicy policy,
+                                 uint32_t basePriority, uint32_t *priorities) {
+    uint32_t highest = basePriority;
+    for (uint32_t i = 0; i < count; i++) {
+        if (policy == PRIORITY_EXPLICIT) {
+            priorities[i] = tasks[i].priority;
+        } else {
+            // one level above every distinct key that is less urgent than ours
+            uint32_t key = urgencyKey(&tasks[i], policy);
+            uint32_t levelsBelow = 0;
+            for (uint32_t j = 0; j < count; j++) {
+                uint32_t other = urgencyKey(&tasks[j], policy);
+                if (other <= key) {
+                    continue;
+                }
+                // count each distinct key once: only at its first occurrence
+                uint32_t k = 0;
+                while (k < j && urgencyKey(&tasks[k], policy) != other) {
+                    k++;
+                }
+                if (k == j) {
+                    levelsBelow++;
+                }
+            }
+            priorities[i] = basePriority + levelsBelow;
+        }
+        if (priorities[i] > highest) {
+            highest = priorities[i];
+        }
+    }
+    return highest;
+}
+
+// utilization of `a` above that of `b`, compared without division
+static bool moreUtilized(const TaskDescriptor *a, const TaskDescriptor *b) {
+    return (uint64_t)a->wcetUs * b->periodUs > (uint64_t)b->wcetUs * a->periodUs;
+}
+
+static uint32_t minU32(uint32_t a, uint32_t b) {
+    return a < b ? a : b;
+}
+
+// utilization of `core` in parts per million
+static uint64_t coreLoad(const TaskDescriptor *tasks, uint32_t count, const uint32_t *coreOf, uint32_t core) {
+    uint64_t load = 0;
+    for (uint32_t j = 0; j < count; j++) {
+        if (coreOf[j] == core) {
+            load += (uint64_t)tasks[j].wcetUs * 1000000u / tasks[j].periodUs;
+        }
+    }
+    return load;
+}
+
+// the tasks with `coreOf[j] == core` are schedulable on it together
+static bool coreSchedulable(const TaskDescriptor *tasks, uint32_t count, const uint32_t *priorities,
+                            const uint32_t *coreOf, uint32_t core) {
+    if (priorities == NULL) {
+        // density in parts per million, rounded up so that the test stays safe
+        uint64_t density = 0;
+        for (uint32_t j = 0; j < count; j++) {
+            if (coreOf[j] == core) {
+                uint32_t window = minU32(tasks[j].deadlineUs, tasks[j].periodUs);
+                density += ((uint64_t)tasks[j].wcetUs * 1000000u + window - 1) / window;
+            }
+        }
+        return density <= 1000000u;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (coreOf[i] != core) {
+            continue;
+        }
+        // R = C_i + sum over the tasks of higher or equal priority of ceil(R / T_j) C_j
+        uint64_t bound = minU32(tasks[i].deadlineUs, tasks[i].periodUs);
+        uint64_t response = tasks[i].wcetUs;
+        for (;;) {
+            uint64_t next = tasks[i].wcetUs;
+            for (uint32_t j = 0; j < count; j++) {
+                if (j != i && coreOf[j] == core && priorities[j] >= priorities[i]) {
+                    next += (response + tasks[j].periodUs - 1) / tasks[j].periodUs * tasks[j].wcetUs;
+                }
+            }
+            if (next > bound) {
+                return false;
+            }
+            if (next == response) {
+                break;
+            }
+            response = next;
+        }
+    }
+    return true;
+}
+
+bool taskSetPartition(const TaskDescriptor *tasks, uint32_t count, const uint32_t *priorities,
+                      uint32_t cores, PartitionHeuristic heuristic, uint32_t *coreOf) {
+    if (cores == 0) {
+        cores = 1;
+    }
+    // `cores` marks a task not placed yet
+    for (uint32_t i = 0; i < count; i++) {
+        coreOf[i] = cores;
+    }
+    bool fits = true;
+    for (uint32_t placed = 0; placed < count; placed++) {
+        // the most utilized task left, the first one among equals
+        uint32_t next = count;
+        for (uint32_t i = 0; i < count; i++) {
+            if (coreOf[i] == cores && (next == count || moreUtilized(&tasks[i], &tasks[next]))) {
+                next = i;
+            }
+        }
+
+        uint32_t chosen = cores;
+        uint64_t chosenLoad = 0;
+        uint32_t leastLoaded = 0;
+        uint64_t leastLoad = UINT64_MAX;
+        for (uint32_t core = 0; core < cores; core++) {
+            uint64_t load = coreLoad(tasks, count, coreOf, core);
+            if (load < leastLoad) {
+                leastLoad = load;
+                leastLoaded = core;
+            }
+            if (chosen != cores && (heuristic == PARTITION_FIRST_FIT_DECREASING || load >= chosenLoad)) {
+                continue;
+            }
+            coreOf[next] = core;
+            if (coreSchedulable(tasks, count, priorities, coreOf, core)) {
+                chosen = core;
+                chosenLoad = load;
+            }
+            coreOf[next] = cores;
+        }
+        if (chosen == cores) {
+            chosen = leastLoaded;
+            fits = false;
+        }
+        coreOf[next] = chosen;
+    }
+    return fits;
+}
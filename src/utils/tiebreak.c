@@ -1,12 +1,18 @@
 #include "utils/tiebreak.h"
 
+// xTaskGetCurrentTaskHandle() returns the TCB running on the calling core, the
+// SMP kernel keeps one current TCB per core
+
 UBaseType_t uxTaskTieBreakerGet() {
-    StaticTask_t** mypxCurrentTCB = (StaticTask_t**)(&pxCurrentTCB);
-    return mypxCurrentTCB[0]->uxDummy5b;
+    StaticTask_t *tcb = (StaticTask_t *)xTaskGetCurrentTaskHandle();
+    return tcb->uxDummy5b;
 }
 
 void vTaskTieBreakerSet(UBaseType_t value) {
-    StaticTask_t** mypxCurrentTCB = (StaticTask_t**)(&pxCurrentTCB);
-    mypxCurrentTCB[0]->uxDummy5b = value;
-    ((ListItem_t*)&(mypxCurrentTCB[0]->xDummy3))->xItemValue = value;
+    StaticTask_t *tcb = (StaticTask_t *)xTaskGetCurrentTaskHandle();
+    // the list item may be linked in a ready list that the other core walks
+    taskENTER_CRITICAL();
+    tcb->uxDummy5b = value;
+    ((ListItem_t *)&(tcb->xDummy3))->xItemValue = value;
+    taskEXIT_CRITICAL();
 }
@@ -0,0 +1,120 @@
+#include "utils/traces/traceFormat.h"
+
+#include <string.h>
+
+// offset of the body inside a frame (after the sync bytes and the header)
+#define FRAME_BODY_OFFSET (2 + TRACE_FRAME_HEADER_SIZE)
+
+uint32_t traceVarintPut(uint8_t *out, uint64_t value) {
+    uint32_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+uint32_t traceVarintGet(const uint8_t *in, uint32_t length, uint64_t *value) {
+    uint64_t result = 0;
+    for (uint32_t n = 0; n < length && n < 10; n++) {
+        result |= (uint64_t)(in[n] & 0x7F) << (7 * n);
+        if ((in[n] & 0x80) == 0) {
+            *value = result;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+uint32_t traceEncodeRecord(uint8_t *out, uint32_t taskNum, uint32_t event, int64_t timestampDelta) {
+    uint32_t n = 0;
+    uint32_t inlineTask = taskNum < TRACE_RECORD_TASK_ESCAPE ? taskNum : TRACE_RECORD_TASK_ESCAPE;
+    uint32_t type = event < TRACE_RECORD_EXTENDED ? event : TRACE_RECORD_EXTENDED;
+    out[n++] = (uint8_t)((inlineTask << TRACE_RECORD_TYPE_BITS) | type);
+    if (inlineTask == TRACE_RECORD_TASK_ESCAPE) {
+        n += traceVarintPut(&out[n], taskNum);
+    }
+    if (type == TRACE_RECORD_EXTENDED) {
+        out[n++] = (uint8_t)event;
+    }
+    // zigzag, so that small negative deltas (events logged out of order) stay short
+    uint64_t zigzag = ((uint64_t)timestampDelta << 1) ^ (uint64_t)(timestampDelta >> 63);
+    n += traceVarintPut(&out[n], zigzag);
+    return n;
+}
+
+uint32_t traceDecodeRecord(const uint8_t *in, uint32_t length, TraceRecord *record) {
+    if (length == 0) {
+        return 0;
+    }
+    uint32_t n = 1;
+    uint64_t value;
+    record->event = in[0] & ((1 << TRACE_RECORD_TYPE_BITS) - 1);
+    record->taskNum = in[0] >> TRACE_RECORD_TYPE_BITS;
+    if (record->taskNum == TRACE_RECORD_TASK_ESCAPE) {
+        uint32_t used = traceVarintGet(&in[n], length - n, &value);
+        if (used == 0 || value > UINT32_MAX) {
+            return 0;
+        }
+        record->taskNum = (uint32_t)value;
+        n += used;
+    }
+    if (record->event == TRACE_RECORD_EXTENDED) {
+        if (n >= length) {
+            return 0;
+        }
+        record->event = in[n++];
+    }
+    uint32_t used = traceVarintGet(&in[n], length - n, &value);
+    if (used == 0) {
+        return 0;
+    }
+    record->timestampDelta = (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+    return n + used;
+}
+
+// CRC-16/CCITT-FALSE (poly 0x1021) with a 16-entry table, cheap enough in flash
+// and in time for the drain task
+static const uint16_t crcNibbleTable[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+uint16_t traceCrc16(uint16_t crc, const uint8_t *data, uint32_t length) {
+    for (uint32_t i = 0; i < length; i++) {
+        crc = (uint16_t)((crc << 4) ^ crcNibbleTable[(crc >> 12) ^ (data[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ crcNibbleTable[(crc >> 12) ^ (data[i] & 0x0F)]);
+    }
+    return crc;
+}
+
+void traceFrameBegin(TraceFrame *frame, uint8_t core, uint16_t seq, uint64_t baseTimestamp) {
+    frame->bytes[0] = TRACE_FRAME_SYNC0;
+    frame->bytes[1] = TRACE_FRAME_SYNC1;
+    frame->bytes[2] = TRACE_FORMAT_VERSION;
+    frame->bytes[3] = core;
+    frame->bytes[4] = (uint8_t)seq;
+    frame->bytes[5] = (uint8_t)(seq >> 8);
+    frame->length = FRAME_BODY_OFFSET;
+    frame->length += traceVarintPut(&frame->bytes[frame->length], baseTimestamp);
+}
+
+bool traceFrameAppend(TraceFrame *frame, const uint8_t *record, uint32_t length) {
+    if (frame->length + length > FRAME_BODY_OFFSET + TRACE_FRAME_MAX_BODY) {
+        return false;
+    }
+    memcpy(&frame->bytes[frame->length], record, length);
+    frame->length += length;
+    return true;
+}
+
+uint32_t traceFrameFinish(TraceFrame *frame) {
+    uint32_t body = frame->length - FRAME_BODY_OFFSET;
+    frame->bytes[6] = (uint8_t)body;
+    frame->bytes[7] = (uint8_t)(body >> 8);
+    uint16_t crc = traceCrc16(0xFFFF, &frame->bytes[2], frame->length - 2);
+    frame->bytes[frame->length++] = (uint8_t)crc;
+    frame->bytes[frame->length++] = (uint8_t)(crc >> 8);
+    return frame->length;
+}
@@ -0,0 +1,12 @@
+#include "utils/traces/tracePort.h"
+
+// host stand-in for get_core_num(): every producer thread claims its own core
+static _Thread_local uint32_t currentCoreId = 0;
+
+void tracePortSetCoreId(uint32_t coreId) {
+    currentCoreId = coreId;
+}
+
+uint32_t tracePortCoreId(void) {
+    return currentCoreId;
+}
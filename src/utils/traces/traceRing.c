@@ -0,0 +1,78 @@
+#include "utils/traces/traceRing.h"
+
+#include <string.h>
+
+#define RING_MASK (TRACE_RING_SIZE - 1)
+
+void traceRingInit(TraceRing *ring) {
+    atomic_store_explicit(&ring->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, 0, memory_order_relaxed);
+    atomic_store_explicit(&ring->dropped, 0, memory_order_relaxed);
+    ring->lastTimestamp = 0;
+    ring->unreported = 0;
+    ring->lossTimestamp = 0;
+}
+
+TraceRingStatus traceRingPush(TraceRing *ring, uint32_t taskNum, uint32_t event, uint64_t timestamp) {
+    // the loss record, if one is due, and the record itself are stored together
+    uint8_t encoded[2 * TRACE_RECORD_MAX_SIZE];
+    uint32_t length = 0;
+    uint64_t base = ring->lastTimestamp;
+    if (ring->unreported > 0) {
+        length = traceEncodeRecord(encoded, ring->unreported, TRACE_EVENT_LOST,
+                                   (int64_t)(ring->lossTimestamp - base));
+        base = ring->lossTimestamp;
+    }
+    length += traceEncodeRecord(&encoded[length], taskNum, event, (int64_t)(timestamp - base));
+
+    // only this producer writes `head`, so a relaxed load returns our own last store
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (TRACE_RING_SIZE - (head - tail) < length) {
+        // `lastTimestamp` is left alone, the next delta stays relative to a stored record
+        if (ring->unreported++ == 0) {
+            ring->lossTimestamp = timestamp;
+        }
+        uint32_t dropped = atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+        atomic_store_explicit(&ring->dropped, dropped + 1, memory_order_relaxed);
+        return TRACE_RING_DROPPED;
+    }
+
+    uint32_t start = head & RING_MASK;
+    uint32_t first = TRACE_RING_SIZE - start < length ? TRACE_RING_SIZE - start : length;
+    memcpy(&ring->bytes[start], encoded, first);
+    memcpy(&ring->bytes[0], &encoded[first], length - first);
+    ring->lastTimestamp = timestamp;
+    ring->unreported = 0;
+
+    // publish the record: the consumer acquires `head` before reading the bytes
+    uint32_t newHead = head + length;
+    atomic_store_explicit(&ring->head, newHead, memory_order_release);
+
+    return ((head ^ newHead) >= TRACE_RING_HALF_SIZE) ? TRACE_RING_HALF_READY : TRACE_RING_OK;
+}
+
+uint32_t traceRingPending(TraceRing *ring) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    return head - tail;
+}
+
+uint32_t traceRingPeek(TraceRing *ring, uint32_t offset, uint32_t pending, uint8_t *encoded, TraceRecord *record) {
+    if (offset >= pending) {
+        return 0;
+    }
+    uint32_t available = pending - offset < TRACE_RECORD_MAX_SIZE ? pending - offset : TRACE_RECORD_MAX_SIZE;
+    uint32_t start = (atomic_load_explicit(&ring->tail, memory_order_relaxed) + offset) & RING_MASK;
+    uint32_t first = TRACE_RING_SIZE - start < available ? TRACE_RING_SIZE - start : available;
+    memcpy(encoded, &ring->bytes[start], first);
+    memcpy(&encoded[first], &ring->bytes[0], available - first);
+    return traceDecodeRecord(encoded, available, record);
+}
+
+void traceRingRelease(TraceRing *ring, uint32_t length) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    // the bytes may only be reused once we are done reading them
+    atomic_store_explicit(&ring->tail, tail + length, memory_order_release);
+}
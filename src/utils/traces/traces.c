@@ -1,97 +1,326 @@
 #include "FreeRTOS.h"
 #include "task.h"
-#include "semphr.h"
 #include "utils/traces/traces.h"
-#include <stdarg.h>
+#include "utils/traces/traceRing.h"
+#include "utils/traces/traceFormat.h"
+#include "utils/traces/tracePort.h"
+#include "utils/taskMemory.h"
 #include <stdio.h>
 #include <string.h>
 
-int32_t logArray[MAX_LOG_SIZE][3];
-volatile uint32_t logIndex = 0;
-SemaphoreHandle_t logMutex = NULL;
-SemaphoreHandle_t logSemaphore = NULL;
-bool isFull = false;
+// one ring per core, each one only ever written from its own core
+static TraceRing traceRings[TRACE_NUM_CORES];
+static TaskHandle_t loggingTaskHandle = NULL;
+STATIC_TASKS(logging, 1, LOGGING_TASK_STACK_SIZE);
+// periodic reports, see setLoggerReport()
+typedef struct {
+    void (*function)(void);
+    TickType_t period;
+    TickType_t next;
+} LoggerReport;
+static LoggerReport reports[LOGGING_MAX_REPORTS];
+static uint32_t reportCount;
+// drain side: absolute timestamp of the last record released from each ring
+static uint64_t drainTimestamp[TRACE_NUM_CORES];
+// drain side: output formatted or encoded so far, handed to the transport in one
+// write once full and at the end of every drain
+static uint8_t batch[LOGGING_BATCH_SIZE];
+static uint32_t batchUsed;
+// written by the logging task only
+static LoggerStats loggerStats;
+// flushLogger() raised the logging task for one unbudgeted drain
+static volatile bool flushRequested = false;
 
-void resetLogger() {
-    logIndex = 0;
-    isFull = false;
+void logEvent(uint32_t taskNum, EventType event, Timestamp timestamp)
+{
+    // the core ID is read with interrupts masked so that the task cannot migrate
+    // to the other core between choosing a ring and writing into it
+    TracePortState state = tracePortEnterLocal();
+    TraceRingStatus status = traceRingPush(&traceRings[tracePortCoreId()], taskNum, event, timestamp);
+    tracePortExitLocal(state);
+
+    // a half of the ring is complete: wake up the logging task to drain it
+    if (status == TRACE_RING_HALF_READY && loggingTaskHandle != NULL) {
+        xTaskNotifyGive(loggingTaskHandle);
+    }
 }
 
-void logEvent(uint32_t taskNum, EventType event, uint32_t timestamp)
+void traceKernelEvent(uint32_t event, uint32_t taskNum)
 {
-    if (logMutex == NULL) {
-        return;
+    // masking nests, this also runs inside the kernel's critical sections and
+    // interrupts; no notification from here, the kernel is in the middle of
+    // something, the next logEvent() or the logging period wakes the drain
+    TracePortState state = tracePortEnterLocal();
+    traceRingPush(&traceRings[tracePortCoreId()], taskNum, event, timestampNow());
+    tracePortExitLocal(state);
+}
+
+uint32_t traceKernelCurrentTaskNumber(void)
+{
+#if configUSE_TRACE_FACILITY
+    return (uint32_t)uxTaskGetTaskNumber(xTaskGetCurrentTaskHandle());
+#else
+    return 0;
+#endif
+}
+
+static void batchFlush(void) {
+    if (batchUsed > 0) {
+        tracePortWrite(batch, batchUsed);
+        loggerStats.bytes += batchUsed;
+        batchUsed = 0;
+    }
+}
+
+static void batchWrite(const void *bytes, uint32_t length) {
+    if (batchUsed + length > sizeof(batch)) {
+        batchFlush();
     }
-    if (logIndex < MAX_LOG_SIZE){
-        if (xSemaphoreTake(logMutex, portMAX_DELAY) == pdTRUE) {
-            logArray[logIndex][0] = taskNum;
-            logArray[logIndex][1] = event;
-            logArray[logIndex][2] = timestamp; 
-
-            logIndex++;  // Increment the log index 
-            xSemaphoreGive(logMutex);
-            // Check if watermark is reached
-            if (logIndex == LOG_WATERMARK) {
-                isFull = true;
-                xSemaphoreGive(logSemaphore);
+    memcpy(batch + batchUsed, bytes, length);
+    batchUsed += length;
+}
+
+// the drain that started at `start` may go on: it is unbudgeted or has time left
+static bool drainBudgetLeft(Timestamp start, bool unbudgeted) {
+    return unbudgeted || LOGGING_DRAIN_BUDGET_US == 0 || timestampNow() - start < LOGGING_DRAIN_BUDGET_US;
+}
+
+#if TRACE_OUTPUT_FORMAT == TRACE_OUTPUT_BINARY
+
+_Static_assert(TRACE_FRAME_MAX_SIZE <= LOGGING_BATCH_SIZE, "a frame must fit in LOGGING_BATCH_SIZE");
+
+static TraceFrame frame;
+static uint16_t frameSeq[TRACE_NUM_CORES];
+
+// send every record committed so far, one frame per core and TRACE_FRAME_MAX_BODY
+// bytes; the host decoder merges the cores back by timestamp. Returns false if
+// the budget ran out first, the rest goes with the next drain
+static bool drainRings(Timestamp start, bool unbudgeted) {
+    for (uint32_t core = 0; core < TRACE_NUM_CORES; core++) {
+        TraceRing *ring = &traceRings[core];
+        // only drain what is there now, events logged meanwhile go to the next dump
+        uint32_t pending = traceRingPending(ring);
+        while (pending > 0) {
+            if (!drainBudgetLeft(start, unbudgeted)) {
+                return false;
+            }
+            uint32_t used = 0;
+            traceFrameBegin(&frame, (uint8_t)core, frameSeq[core]++, drainTimestamp[core]);
+            for (;;) {
+                uint8_t encoded[TRACE_RECORD_MAX_SIZE];
+                TraceRecord record;
+                uint32_t length = traceRingPeek(ring, used, pending, encoded, &record);
+                if (length == 0 || !traceFrameAppend(&frame, encoded, length)) {
+                    break;
+                }
+                drainTimestamp[core] += record.timestampDelta;
+                used += length;
+                loggerStats.records++;
+            }
+            if (used == 0) {
+                // cannot be decoded: discard it, the skipped sequence number marks the gap
+                traceRingRelease(ring, pending);
+                break;
+            }
+            batchWrite(frame.bytes, traceFrameFinish(&frame));
+            // give the bytes back right away so that the producer can reuse them
+            traceRingRelease(ring, used);
+            pending -= used;
+        }
+    }
+    return true;
+}
+
+#else
+
+// print every record committed so far, merging the per-core rings by timestamp
+// so that the dump keeps the single-stream CSV layout; with more than one core
+// the core of every record follows as a fourth column (trace2json --per-core).
+// Returns false if the budget ran out first, the rest goes with the next drain
+static bool drainRings(Timestamp start, bool unbudgeted) {
+    static const char dumpStart[] = "====Log dump start====\n";
+    static const char dumpEnd[] = "====Log dump end====\n";
+    uint32_t pending[TRACE_NUM_CORES];
+    bool complete = true;
+    // only drain what is there now, events logged meanwhile go to the next dump
+    for (uint32_t core = 0; core < TRACE_NUM_CORES; core++) {
+        pending[core] = traceRingPending(&traceRings[core]);
+    }
+    batchWrite(dumpStart, sizeof(dumpStart) - 1);
+    for (;;) {
+        if (!drainBudgetLeft(start, unbudgeted)) {
+            complete = false;
+            break;
+        }
+        int next = -1;
+        TraceRecord nextRecord;
+        uint32_t nextLength = 0;
+        uint64_t nextTimestamp = 0;
+        for (uint32_t core = 0; core < TRACE_NUM_CORES; core++) {
+            uint8_t encoded[TRACE_RECORD_MAX_SIZE];
+            TraceRecord record;
+            uint32_t length = traceRingPeek(&traceRings[core], 0, pending[core], encoded, &record);
+            if (length == 0) {
+                continue;
+            }
+            uint64_t timestamp = drainTimestamp[core] + record.timestampDelta;
+            if (next < 0 || timestamp < nextTimestamp) {
+                next = core;
+                nextRecord = record;
+                nextLength = length;
+                nextTimestamp = timestamp;
             }
         }
+        if (next < 0) {
+            break;
+        }
+        char line[48];
+#if TRACE_NUM_CORES > 1
+        int length = snprintf(line, sizeof(line), "%u,%u,%llu,%d\n", (unsigned)nextRecord.taskNum,
+                              (unsigned)nextRecord.event, (unsigned long long)nextTimestamp, next);
+#else
+        int length = snprintf(line, sizeof(line), "%u,%u,%llu\n", (unsigned)nextRecord.taskNum,
+                              (unsigned)nextRecord.event, (unsigned long long)nextTimestamp);
+#endif
+        batchWrite(line, (uint32_t)length);
+        loggerStats.records++;
+        drainTimestamp[next] = nextTimestamp;
+        // give the bytes back right away so that the producer can reuse them
+        traceRingRelease(&traceRings[next], nextLength);
+        pending[next] -= nextLength;
     }
-    else {
-        isFull = true;
-        xSemaphoreGive(logSemaphore);
+    batchWrite(dumpEnd, sizeof(dumpEnd) - 1);
+    return complete;
+}
+
+#endif // TRACE_OUTPUT_FORMAT
+
+// call the reports that are due, returns whether there was one
+static bool runReports(void) {
+    bool ran = false;
+    for (uint32_t i = 0; i < reportCount; i++) {
+        if ((int32_t)(xTaskGetTickCount() - reports[i].next) >= 0) {
+            reports[i].function();
+            reports[i].next = xTaskGetTickCount() + reports[i].period;
+            ran = true;
+        }
     }
+    return ran;
 }
 
 void vLoggingTask(void *pvParameters) {
     const uint32_t taskID = 0;
-    TickType_t xLastWakeTime = xTaskGetTickCount();  
     const TickType_t xExecutionPeriod = pdMS_TO_TICKS(LOGGING_PERIOD_MS);
+    bool backlog = false;
     for (;;) {
-        // Wait until either the semaphore is given or the timeout occurs
-        xSemaphoreTake(logSemaphore, xExecutionPeriod);
+        if (backlog) {
+            // the budget of the last drain ran out: go on after the next tick,
+            // whatever notifications come meanwhile
+            vTaskDelay(1);
+        } else {
+            TickType_t timeout = xExecutionPeriod;
+            for (uint32_t i = 0; i < reportCount; i++) {
+                // signed difference, so that the tick count may wrap
+                int32_t untilReport = (int32_t)(reports[i].next - xTaskGetTickCount());
+                if (untilReport < 0) {
+                    untilReport = 0;
+                }
+                if ((TickType_t)untilReport < timeout) {
+                    timeout = (TickType_t)untilReport;
+                }
+            }
+            // Wait until either a ring half is complete or the timeout occurs
+            ulTaskNotifyTake(pdTRUE, timeout);
+        }
+        bool flush = flushRequested;
+        flushRequested = false;
         // record the time at which the task started the execution of a job
-        logEvent(taskID, JOB_START, (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS));
-        // Print the logs. Minimize the amount of time the mutex is held
-        printf("====Log dump start====\n");
-        uint32_t i = 0;
-        for (; i < logIndex-1; i++) {
-            printf("%d,%d,%d\n", logArray[i][0], logArray[i][1], logArray[i][2]);
+        Timestamp start = timestampNow();
+        logEvent(taskID, JOB_START, start);
+        // Dump the logs. The rings are lock-free, producers keep logging meanwhile
+        backlog = !drainRings(start, flush);
+        batchFlush();
+        if (!backlog && runReports()) {
+            reportLoggerStats();
         }
-        // take the mutex only for the last entry to avoid holding it for too long
-        // note that in most cases it will only be needed for the last entry
-        // but in case of high logging frequency, there may have been new entries added
-        // since we last checked `logIndex`
-        if (xSemaphoreTake(logMutex, portMAX_DELAY) == pdTRUE) {
-            for (; i < logIndex; i++) {
-                printf("%d,%d,%d\n", logArray[i][0], logArray[i][1], logArray[i][2]);
-            }
-            printf("====Log dump end====\n");
-            resetLogger();
-            xSemaphoreGive(logMutex);
+        Timestamp completion = timestampNow();
+        uint32_t elapsed = (uint32_t)(completion - start);
+        loggerStats.drains++;
+        loggerStats.busyUs += elapsed;
+        if (elapsed > loggerStats.maxDrainUs) {
+            loggerStats.maxDrainUs = elapsed;
+        }
+        if (backlog) {
+            loggerStats.budgetExhausted++;
         }
         // record the time at which the task completed the execution of a job
-        logEvent(taskID, JOB_COMPLETION, (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS));
+        logEvent(taskID, JOB_COMPLETION, completion);
+        if (flush) {
+            vTaskPrioritySet(NULL, LOGGING_TASK_PRIORITY);
+        }
     }
     vTaskDelete(NULL);
 }
 
-void initLogger() {
-    // Create the mutex only once during initialization
-    logMutex = xSemaphoreCreateMutex();    
-    if (logMutex == NULL) {
-        printf("Failed to create log mutex!\n");
-        return;
+void setLoggerReport(void (*report)(void), uint32_t periodMs) {
+    uint32_t i = 0;
+    while (i < reportCount && reports[i].function != report) {
+        i++;
     }
-    logSemaphore = xSemaphoreCreateBinary();
-    if (logSemaphore == NULL) {
-        printf("Failed to create log semaphore!\n");
+    if (i == LOGGING_MAX_REPORTS) {
+        printf("Too many logger reports!\n");
         return;
     }
-    if (xSemaphoreTake(logMutex, portMAX_DELAY) == pdTRUE) {
-        resetLogger();
-        xSemaphoreGive(logMutex);
+    reports[i].period = pdMS_TO_TICKS(periodMs);
+    reports[i].next = xTaskGetTickCount() + reports[i].period;
+    reports[i].function = report;
+    if (i == reportCount) {
+        reportCount++;
+    }
+}
+
+void flushLogger() {
+    if (loggingTaskHandle != NULL) {
+        // one drain above every other task and without budget, then the logging
+        // task drops back to LOGGING_TASK_PRIORITY
+        flushRequested = true;
+        vTaskPrioritySet(loggingTaskHandle, configMAX_PRIORITIES - 1);
+        xTaskNotifyGive(loggingTaskHandle);
+    }
+}
+
+void getLoggerStats(LoggerStats *stats) {
+    *stats = loggerStats;
+    stats->dropped = 0;
+    for (uint32_t core = 0; core < TRACE_NUM_CORES; core++) {
+        stats->dropped += atomic_load_explicit(&traceRings[core].dropped, memory_order_relaxed);
+    }
+}
+
+void reportLoggerStats() {
+    LoggerStats stats;
+    getLoggerStats(&stats);
+    Timestamp uptime = timestampNow();
+    printf("logger: %u drains, %u records, %u bytes, busy %llu us (%u.%u%%), max %u us per drain,"
+           " %u cut by the budget, %u dropped\n",
+           (unsigned)stats.drains, (unsigned)stats.records, (unsigned)stats.bytes,
+           (unsigned long long)stats.busyUs,
+           (unsigned)(uptime > 0 ? stats.busyUs * 100 / uptime : 0),
+           (unsigned)(uptime > 0 ? stats.busyUs * 1000 / uptime % 10 : 0),
+           (unsigned)stats.maxDrainUs, (unsigned)stats.budgetExhausted, (unsigned)stats.dropped);
+}
+
+void initLogger() {
+    for (uint32_t core = 0; core < TRACE_NUM_CORES; core++) {
+        traceRingInit(&traceRings[core]);
+        drainTimestamp[core] = 0;
+    }
+    batchUsed = 0;
+    if (createTrackedTask(vLoggingTask, "Logging Task", LOGGING_TASK_STACK_SIZE, NULL, LOGGING_TASK_PRIORITY,
+                          TASK_ANY_CORE, STATIC_TASK_STACK(logging, 0), STATIC_TASK_TCB(logging, 0),
+                          &loggingTaskHandle) != pdPASS) {
+        printf("Failed to create logging task!\n");
+        return;
     }
-    xTaskCreate(vLoggingTask, "Logging Task", 8192, NULL, configMAX_PRIORITIES - 1, NULL);
     printf("Logging task created\n");
-}
\ No newline at end of file
+}
@@ -0,0 +1,97 @@
+#include "utils/workload.h"
+#include "utils/timestamp.h"
+#include <stddef.h>
+
+#define VECTORSIZE 16
+// global, so that the compiler has to perform every store of the loop
+unsigned int v[VECTORSIZE] = {1};
+
+static uint32_t loopsPerMs = WORKLOAD_DEFAULT_LOOPS_PER_MS;
+static uint32_t scalePercent = 100;
+
+// one unit of work per iteration, the loop busyDelay() always used
+static void workloadLoop(uint32_t loops) {
+    unsigned int k = 0;
+    for (uint32_t j = 0; j < loops; j++) {
+        k = v[j % VECTORSIZE] * v[(k + j) % VECTORSIZE];
+        v[j % VECTORSIZE] = k;
+    }
+}
+
+static Timestamp measure(uint32_t loops) {
+    Timestamp start = timestampNow();
+    workloadLoop(loops);
+    return timestampNow() - start;
+}
+
+void workloadCalibrate(void) {
+    // grow the measurement until it is long enough for the clock resolution,
+    // which also warms up the caches
+    uint32_t loops = 1024;
+    Timestamp fastest = measure(loops);
+    while (fastest < WORKLOAD_CALIBRATION_US && loops < (1u << 30)) {
+        loops *= 2;
+        fastest = measure(loops);
+    }
+    for (int round = 1; round < WORKLOAD_CALIBRATION_ROUNDS; round++) {
+        Timestamp elapsed = measure(loops);
+        if (elapsed < fastest) {
+            fastest = elapsed;
+        }
+    }
+    if (fastest == 0) {
+        fastest = 1;
+    }
+    loopsPerMs = (uint32_t)((uint64_t)loops * TIMESTAMP_US_PER_MS / fastest);
+}
+
+uint32_t workloadLoopsPerMs(void) {
+    return loopsPerMs;
+}
+
+void workloadRun(uint32_t us) {
+    uint64_t loops = (uint64_t)us * scalePercent * loopsPerMs / (100 * TIMESTAMP_US_PER_MS);
+    while (loops > UINT32_MAX) {
+        workloadLoop(UINT32_MAX);
+        loops -= UINT32_MAX;
+    }
+    workloadLoop((uint32_t)loops);
+}
+
+void workloadSetScale(uint32_t percent) {
+    scalePercent = percent;
+}
+
+void workloadSequenceInit(WorkloadSequence *sequence, const WorkloadModel *model, uint32_t wcetUs, uint32_t seed) {
+    sequence->model = model;
+    sequence->wcetUs = wcetUs;
+    // xorshift needs a non-zero state
+    sequence->random = seed * 2654435761u + 1;
+    sequence->next = 0;
+}
+
+uint32_t workloadSequenceNext(WorkloadSequence *sequence) {
+    const WorkloadModel *model = sequence->model;
+    if (model == NULL || model->kind == WORKLOAD_WCET) {
+        return sequence->wcetUs;
+    }
+    if (model->kind == WORKLOAD_UNIFORM) {
+        // xorshift32, plenty for load generation
+        uint32_t x = sequence->random;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        sequence->random = x;
+        if (model->maxUs <= model->minUs) {
+            return model->minUs;
+        }
+        uint64_t span = (uint64_t)model->maxUs - model->minUs + 1;
+        return model->minUs + (uint32_t)(((uint64_t)x * span) >> 32);
+    }
+    if (model->count == 0) {
+        return sequence->wcetUs;
+    }
+    uint32_t us = model->trace[sequence->next];
+    sequence->next = sequence->next + 1 < model->count ? sequence->next + 1 : 0;
+    return us;
+}
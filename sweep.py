@@ -0,0 +1,183 @@
+# Breakdown utilization of the task set on the FreeRTOS POSIX build, and plots
+# of the breakdown utilizations found by host/tools/sched_sweep.cpp.
+#
+#   python3 sweep.py posix [--seconds S] [--start P] [--step P] [--max P] [--csv out.csv] rts_posix_fp...
+#   python3 sweep.py plot [--out sweep.png] sweep.csv...
+#
+# `posix` runs every given executable (host/posix, one per scheduling mode) with
+# the execution times of taskTable.c stretched to P percent, from --start
+# (default 50) up by --step (default 5) to --max (default 300), each for S
+# seconds (default 3), until a task misses a deadline. The last utilization
+# without a miss is the breakdown utilization of the task set on the real
+# scheduler, to be set against sched_sweep --firmware; --csv writes it in the
+# layout of sched_sweep --csv.
+#
+# `plot` draws, from sched_sweep --csv files (and posix ones), the fraction of
+# the task sets still schedulable at every utilization, one line per policy and
+# core count, and the distribution of the breakdown utilizations. It needs
+# matplotlib.
+
+import csv
+import os
+import re
+import subprocess
+import sys
+
+columns = ['set', 'policy', 'cores', 'placement', 'method', 'utilization', 'breakdown']
+
+
+def run_posix(binary, seconds, percent):
+    # the trace goes to stdout, the statistics to stderr
+    result = subprocess.run([binary, str(seconds), 'periodic', str(percent)], stdout=subprocess.DEVNULL,
+                            stderr=subprocess.PIPE, text=True)
+    utilization = None
+    missed = 0
+    for line in result.stderr.splitlines():
+        match = re.match(r'Execution times at \d+%: utilization ([0-9.]+)', line)
+        if match:
+            utilization = float(match.group(1))
+        match = re.match(r'Task \d+: \d+ met, (\d+) missed', line)
+        if match:
+            missed += int(match.group(1))
+    if result.returncode != 0 or utilization is None:
+        raise RuntimeError('%s failed at %d%%:\n%s' % (binary, percent, result.stderr))
+    return utilization, missed
+
+
+def posix(argv):
+    seconds, start, step, maximum = 3, 50, 5, 300
+    out = None
+    binaries = []
+    i = 0
+    while i < len(argv):
+        if argv[i] in ('--seconds', '--start', '--step', '--max', '--csv') and i + 1 < len(argv):
+            value = argv[i + 1]
+            if argv[i] == '--csv':
+                out = value
+            elif argv[i] == '--seconds':
+                seconds = int(value)
+            elif argv[i] == '--start':
+                start = int(value)
+            elif argv[i] == '--step':
+                step = int(value)
+            else:
+                maximum = int(value)
+            i += 1
+        else:
+            binaries.append(argv[i])
+        i += 1
+    if not binaries or step <= 0 or start > maximum:
+        print('usage: sweep.py posix [--seconds S] [--start P] [--step P] [--max P] [--csv out.csv] rts_posix...',
+              file=sys.stderr)
+        return 2
+
+    rows = []
+    for binary in binaries:
+        # rts_posix_fp -> fp
+        policy = os.path.basename(binary).replace('rts_posix_', '')
+        base = None
+        breakdown = 0.0
+        for percent in range(start, maximum + 1, step):
+            utilization, missed = run_posix(binary, seconds, percent)
+            if base is None:
+                base = utilization * 100 / percent
+            print('%-8s %4d%%  utilization %.3f  %d missed' % (policy, percent, utilization, missed))
+            if missed > 0:
+                break
+            breakdown = utilization
+        print('%s: breakdown utilization %.3f' % (policy, breakdown))
+        rows.append(['firmware', policy, 1, 'partitioned', 'posix', '%.4f' % base, '%.4f' % breakdown])
+
+    if out is not None:
+        with open(out, 'w', newline='') as csvfile:
+            writer = csv.writer(csvfile)
+            writer.writerow(columns)
+            writer.writerows(rows)
+    return 0
+
+
+def load(paths):
+    # breakdowns per (policy, cores, placement, method)
+    series = {}
+    for path in paths:
+        with open(path, newline='') as csvfile:
+            for row in csv.DictReader(csvfile):
+                key = (row['policy'], int(row['cores']), row['placement'], row['method'])
+                series.setdefault(key, []).append(float(row['breakdown']))
+    return series
+
+
+def label(key):
+    policy, cores, placement, method = key
+    name = '%s, %d core%s' % (policy, cores, 's' if cores > 1 else '')
+    if cores > 1:
+        name += ' ' + placement
+    return '%s (%s)' % (name, method)
+
+
+def plot(argv):
+    out = 'sweep.png'
+    paths = []
+    i = 0
+    while i < len(argv):
+        if argv[i] == '--out' and i + 1 < len(argv):
+            out = argv[i + 1]
+            i += 1
+        else:
+            paths.append(argv[i])
+        i += 1
+    if not paths:
+        print('usage: sweep.py plot [--out sweep.png] sweep.csv...', file=sys.stderr)
+        return 2
+
+    series = load(paths)
+    for key, values in sorted(series.items()):
+        print('%-40s %5d sets, breakdown mean %.3f, min %.3f' % (label(key), len(values),
+                                                                  sum(values) / len(values), min(values)))
+
+    try:
+        import matplotlib
+        matplotlib.use('Agg')
+        import matplotlib.pyplot as plt
+    except ImportError:
+        print('matplotlib is needed for the plots', file=sys.stderr)
+        return 1
+
+    figure, (acceptance, spread) = plt.subplots(1, 2, figsize=(13, 5))
+    keys = sorted(series)
+    top = max(cores for _, cores, _, _ in keys)
+    grid = [k / 100 for k in range(0, 100 * top + 1)]
+    for key in keys:
+        values = series[key]
+        # a set is schedulable at every utilization up to its breakdown
+        accepted = [sum(1 for value in values if value >= u - 1e-9) / len(values) for u in grid]
+        acceptance.plot(grid, accepted, label=label(key))
+    acceptance.set_xlabel('utilization')
+    acceptance.set_ylabel('schedulable task sets')
+    acceptance.set_ylim(0, 1.02)
+    acceptance.grid(True, alpha=0.3)
+    acceptance.legend(fontsize='small')
+
+    spread.boxplot([series[key] for key in keys], vert=False)
+    spread.set_yticks(range(1, len(keys) + 1))
+    spread.set_yticklabels([label(key) for key in keys], fontsize='small')
+    spread.set_xlabel('breakdown utilization')
+    spread.grid(True, axis='x', alpha=0.3)
+
+    figure.tight_layout()
+    figure.savefig(out, dpi=120)
+    print('Wrote %s' % out)
+    return 0
+
+
+def main(argv):
+    if argv and argv[0] == 'posix':
+        return posix(argv[1:])
+    if argv and argv[0] == 'plot':
+        return plot(argv[1:])
+    print('usage: sweep.py posix|plot ...', file=sys.stderr)
+    return 2
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))